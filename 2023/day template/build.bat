@@ -6,8 +6,14 @@ REM Set build tool and library paths as well as compile flags here.
 
 set debug_flags=/Od /Z7 /MTd
 set release_flags=/O2 /GL /MT /analyze- /D NDEBUG
-set common_flags=/W3 /Gm- /EHsc /nologo /Fe: Engine.exe /I ..\..\src ..\..\src\UnityBuild.cpp
-set linker_flags=/INCREMENTAL:no /NOLOGO /SUBSYSTEM:CONSOLE user32.lib
+REM Set profile_flags=/D PROFILE_ENABLED to record PROFILE_SCOPE() zones and write profile.json after each run.
+set profile_flags=
+REM Add /D MEMORY_TRACKING_ENABLED /Z7 to profile_flags to count allocations per part and per call site as well (/Z7 lets the sites print as function names).
+REM Stamp the build with the current git revision (if there is one), so saved benchmark results can say what they measured.
+set git_revision=unknown
+for /f %%i in ('git rev-parse --short HEAD 2^>nul') do set git_revision=%%i
+set common_flags=/std:c++20 /W3 /Gm- /EHsc /nologo %profile_flags% /D GIT_REVISION=\"%git_revision%\" /Fe: Engine.exe /I ..\..\src ..\..\src\UnityBuild.cpp
+set linker_flags=/INCREMENTAL:no /NOLOGO /SUBSYSTEM:CONSOLE user32.lib synchronization.lib dbghelp.lib
 
 REM Run the build tools, but only if they aren't set up already.
 
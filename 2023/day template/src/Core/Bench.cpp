@@ -0,0 +1,257 @@
+#include "Core/Bench.h"
+#include "Platform/Platform.h"
+#include <math.h>
+
+namespace BenchInternal
+{
+// Two-sided 95% critical values of Student's t distribution, for 1 to 30 degrees of freedom.
+static const double TCritical95[30] =
+{
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+// Rounds the degrees of freedom down, which only ever makes the test stricter.
+static double CriticalT(double df)
+{
+    if (df < 1.0) return TCritical95[0];
+    if (df < 30.0) return TCritical95[(s32)df - 1];
+    if (df < 40.0) return TCritical95[29]; // df = 30.
+    if (df < 60.0) return 2.021; // df = 40.
+    if (df < 120.0) return 2.000; // df = 60.
+    return 1.980; // df = 120. The 1.960 limit is only reached at infinity.
+}
+
+static int CompareSamples(const void* p1, const void* p2)
+{
+    u64 a = *(const u64*)p1;
+    u64 b = *(const u64*)p2;
+    return (a < b) ? -1 : (a > b) ? 1 : 0;
+}
+
+// Appends text to a JSON string, escaping anything that would end it early.
+static void AppendJsonString(MString* out, const char* text)
+{
+    out->Append('"');
+    for (const char* c = text; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\') out->Append('\\');
+        out->Append(*c);
+    }
+    out->Append('"');
+}
+
+static bool IsSpace(char c) {return (c == ' ' || c == '\t' || c == '\r' || c == '\n');}
+
+static s64 SkipSpaces(IString json, s64 offset)
+{
+    while (offset < (s64)json.Length() && IsSpace(json[offset])) offset += 1;
+    return offset;
+}
+
+// Finds "key": at or after offset, and returns the offset of its value. Returns -1 if there isn't one.
+// This is only meant to read back what WriteJson() wrote (possibly re-indented), not arbitrary JSON.
+static s64 FindValue(IString json, s64 offset, const char* key)
+{
+    char quoted_key[64];
+    StrPrintF(quoted_key, sizeof(quoted_key), "\"%s\"", key);
+    for (;;)
+    {
+        MSTRING_SIZE_T found = json.Find(quoted_key, (MSTRING_SIZE_T)offset);
+        if (found == IString::NotFound) return -1;
+        offset = SkipSpaces(json, (s64)found + StrLen(quoted_key));
+        if (offset < (s64)json.Length() && json[offset] == ':') return SkipSpaces(json, offset + 1);
+    }
+}
+
+// The string value at offset, without its quotes. Empty if there isn't one.
+static IString StringValue(IString json, s64 offset)
+{
+    if (offset < 0 || offset >= (s64)json.Length() || json[offset] != '"') return {};
+    MSTRING_SIZE_T end = json.FindChar('"', (MSTRING_SIZE_T)offset + 1);
+    if (end == IString::NotFound) return {};
+    return json.SubString((MSTRING_SIZE_T)offset + 1, end - (MSTRING_SIZE_T)offset - 1);
+}
+
+// Reads the samples_us array of the part with the given name.
+static bool FindSamples(IString json, const char* name, TArray<u64>* out_samples)
+{
+    s64 offset = FindValue(json, 0, "parts");
+    while (offset >= 0)
+    {
+        offset = FindValue(json, offset, "name");
+        if (offset < 0) return false;
+        if (StringValue(json, offset) == name) break;
+    }
+    if (offset < 0) return false;
+
+    offset = FindValue(json, offset, "samples_us");
+    if (offset < 0 || offset >= (s64)json.Length() || json[offset] != '[') return false;
+    offset = SkipSpaces(json, offset + 1);
+    while (offset < (s64)json.Length() && json[offset] != ']')
+    {
+        if (!IsDigit(json[offset])) return false;
+        out_samples->Append(ParseUnsigned(json, &offset));
+        offset = SkipSpaces(json, offset);
+        if (offset < (s64)json.Length() && json[offset] == ',') offset = SkipSpaces(json, offset + 1);
+    }
+    return true;
+}
+} // namespace BenchInternal
+
+Bench::Stats Bench::Summarize(Span<const u64> samples)
+{
+    using namespace BenchInternal;
+    Stats result = {};
+    result.count = samples.count;
+    if (!samples.count) return result;
+
+    TArray<u64> sorted = TArray<u64>((tarray_int)samples.count);
+    memcpy(&sorted[0], samples.ptr, samples.ByteSize());
+    qsort(&sorted[0], sorted.Length(), sizeof(u64), CompareSamples);
+
+    s64 middle = samples.count / 2;
+    result.min = sorted[0];
+    result.median = (samples.count & 1) ? sorted[(tarray_int)middle] : (sorted[(tarray_int)middle - 1] + sorted[(tarray_int)middle]) / 2;
+
+    double sum = 0.0;
+    for (u64 sample : samples) sum += (double)sample;
+    result.mean = sum / (double)samples.count;
+    if (samples.count > 1)
+    {
+        double squares = 0.0;
+        for (u64 sample : samples) squares += ((double)sample - result.mean) * ((double)sample - result.mean);
+        result.stddev = sqrt(squares / (double)(samples.count - 1));
+    }
+    return result;
+}
+
+u64 Bench::HashInput(Span<const u8> input)
+{
+    u64 hash = 0xcbf29ce484222325ull;
+    for (u8 byte : input)
+    {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool Bench::WriteJson(IString path, const RunRecord& run)
+{
+    using namespace BenchInternal;
+    char buffer[256];
+    MString json = "{\n  \"day\": ";
+    AppendJsonString(&json, run.day);
+    json.Append(",\n  \"git_revision\": ");
+    AppendJsonString(&json, run.git_revision);
+    json.Append(",\n  \"cpu\": ");
+    AppendJsonString(&json, run.cpu);
+    StrPrintF(buffer, sizeof(buffer), ",\n  \"input_hash\": \"%016llx\",\n  \"concurrent\": %s,\n  \"parts\": [",
+              run.input_hash, (run.concurrent) ? "true" : "false");
+    json.Append(buffer);
+
+    for (s64 i = 0; i < run.parts.count; ++i)
+    {
+        const PartRecord& part = run.parts[i];
+        Stats stats = Summarize(part.samples_us);
+        json.Append((i) ? ",\n    {\n      \"name\": " : "\n    {\n      \"name\": ");
+        AppendJsonString(&json, part.name);
+        StrPrintF(buffer, sizeof(buffer), ",\n      \"answer\": %lld,\n      \"runs\": %lld,\n      \"min_us\": %llu,\n      \"median_us\": %llu,"
+                  "\n      \"mean_us\": %.3f,\n      \"stddev_us\": %.3f,\n      \"samples_us\": [",
+                  part.answer, stats.count, stats.min, stats.median, stats.mean, stats.stddev);
+        json.Append(buffer);
+        for (s64 sample = 0; sample < part.samples_us.count; ++sample)
+        {
+            StrPrintF(buffer, sizeof(buffer), (sample) ? ", %llu" : "%llu", part.samples_us[sample]);
+            json.Append(buffer);
+        }
+        json.Append("]");
+#ifdef MEMORY_TRACKING_ENABLED
+        if (part.memory)
+        {
+            const Memory::Stats* memory = part.memory;
+            StrPrintF(buffer, sizeof(buffer), ",\n      \"counters\": {\"allocations\": %lld, \"reallocs\": %lld, \"frees\": %lld, "
+                      "\"bytes_requested\": %lld, \"bytes_copied\": %lld, \"peak_bytes\": %lld}",
+                      memory->allocations, memory->reallocs, memory->frees, memory->bytes_requested, memory->bytes_copied, memory->peak_bytes);
+            json.Append(buffer);
+        }
+#endif
+        json.Append("\n    }");
+    }
+    json.Append("\n  ]\n}\n");
+    return Platform::WriteBufferToFile(path, {(const u8*)json.Ptr(), (s64)json.Length()});
+}
+
+bool Bench::AppendHistory(IString path, const RunRecord& run)
+{
+    char buffer[512];
+    MString csv = {};
+    if (Platform::GetFileSize(path) <= 0) csv.Append("day,git_revision,cpu,input_hash,concurrent,part,answer,runs,min_us,median_us,mean_us,stddev_us\n");
+    for (const PartRecord& part : run.parts)
+    {
+        Stats stats = Summarize(part.samples_us);
+        StrPrintF(buffer, sizeof(buffer), "%s,%s,\"%s\",%016llx,%d,%s,%lld,%lld,%llu,%llu,%.3f,%.3f\n",
+                  run.day, run.git_revision, run.cpu, run.input_hash, (s32)run.concurrent, part.name, part.answer,
+                  stats.count, stats.min, stats.median, stats.mean, stats.stddev);
+        csv.Append(buffer);
+    }
+    return Platform::WriteBufferToFile(path, {(const u8*)csv.Ptr(), (s64)csv.Length()}, true);
+}
+
+s32 Bench::CompareToBaseline(IString path, const RunRecord& run)
+{
+    using namespace BenchInternal;
+    Span<u8> file = Platform::ReadFileToBuffer(path);
+    if (!file.ptr) return -1;
+    IString json = {(const char*)file.ptr, (MSTRING_SIZE_T)file.count};
+
+    // Say what we're comparing against, and warn if it wasn't measured on the same input or machine.
+    IString revision = StringValue(json, FindValue(json, 0, "git_revision"));
+    PrintF("\nCompared to %.*s (revision %.*s):\n", (s32)path.Length(), path.Ptr(), (s32)revision.Length(), revision.Ptr());
+    char hash[17];
+    StrPrintF(hash, sizeof(hash), "%016llx", run.input_hash);
+    if (!(StringValue(json, FindValue(json, 0, "input_hash")) == hash)) PrintLog("Warning: the baseline was measured with a different input.\n");
+    if (!(StringValue(json, FindValue(json, 0, "cpu")) == run.cpu)) PrintLog("Warning: the baseline was measured on a different CPU.\n");
+
+    s32 regressions = 0;
+    for (const PartRecord& part : run.parts)
+    {
+        TArray<u64> baseline_samples = {};
+        if (!FindSamples(json, part.name, &baseline_samples) || !baseline_samples.Length())
+        {
+            PrintF("%-8s not in the baseline\n", part.name);
+            continue;
+        }
+        Stats before = Summarize({baseline_samples.begin(), baseline_samples.Length()});
+        Stats after = Summarize(part.samples_us);
+        double change = (before.mean > 0.0) ? (after.mean - before.mean) / before.mean : 0.0;
+
+        // Welch's t-test, since the two sides can have different run counts and variances.
+        const char* verdict = "no significant change";
+        if (before.count < 2 || after.count < 2) verdict = "not enough runs to tell (use --runs)";
+        else
+        {
+            double before_error = before.stddev * before.stddev / (double)before.count;
+            double after_error = after.stddev * after.stddev / (double)after.count;
+            double error = before_error + after_error;
+            bool significant = (after.mean != before.mean);
+            if (error > 0.0)
+            {
+                double t = (after.mean - before.mean) / sqrt(error);
+                double df = (error * error) / ((before_error * before_error) / (double)(before.count - 1) + (after_error * after_error) / (double)(after.count - 1));
+                significant = (fabs(t) > CriticalT(df));
+            }
+            if (significant && fabs(change) >= MinRelativeChange)
+            {
+                verdict = (change > 0.0) ? "REGRESSION" : "improvement";
+                if (change > 0.0) regressions += 1;
+            }
+        }
+        PrintF("%-8s median %8lluus -> %8lluus, mean %+7.1f%%  %s\n", part.name, before.median, after.median, change * 100.0, verdict);
+    }
+
+    MEMORY_FREE(file.ptr);
+    return regressions;
+}
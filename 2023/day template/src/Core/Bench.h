@@ -0,0 +1,67 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// Benchmark records. The runner collects one timing sample per run for parsing and each part, and these
+// turn them into something that outlives the console:
+//
+// WriteJson() writes a whole run, including every sample, and that file is what CompareToBaseline() reads
+// back. AppendHistory() adds one CSV line per part to a running log, so results can be tracked over time
+// (a header is written first if the file is new or empty).
+//
+// Comparisons use Welch's t-test on the samples, so they need at least two runs on both sides to say
+// anything (see --runs). A part is only flagged when the difference is significant at 95% and the mean moved
+// by at least MinRelativeChange, so that tiny but consistent differences aren't reported as regressions.
+//
+// The git revision comes from GIT_REVISION, which build.bat defines from `git rev-parse` when it can.
+
+#ifndef GIT_REVISION
+#define GIT_REVISION "unknown"
+#endif
+
+namespace Bench
+{
+    constexpr double MinRelativeChange = 0.02;
+
+    struct Stats
+    {
+        s64 count;
+        u64 min;
+        u64 median;
+        double mean;
+        double stddev; // Sample standard deviation, 0 with fewer than two samples.
+    };
+
+    Stats Summarize(Span<const u64> samples);
+
+    // 64-bit FNV-1a of the input file, so results from different inputs aren't compared by accident. This
+    // gets saved, so unlike IString::Hash() it has to be the same in every build.
+    u64 HashInput(Span<const u8> input);
+
+    struct PartRecord
+    {
+        const char* name; // Matched by name against the baseline, so keep these stable ("Parse", "Part 1"...).
+        s64 answer;
+        Span<const u64> samples_us;
+#ifdef MEMORY_TRACKING_ENABLED
+        const Memory::Stats* memory; // Written out as counters, if set.
+#endif
+    };
+
+    struct RunRecord
+    {
+        const char* day;
+        u64 input_hash;
+        const char* git_revision;
+        const char* cpu;
+        bool concurrent;
+        Span<const PartRecord> parts;
+    };
+
+    bool WriteJson(IString path, const RunRecord& run);
+    bool AppendHistory(IString path, const RunRecord& run);
+
+    // Prints a line per part comparing it to the baseline written by WriteJson(). Returns the number of
+    // parts that got significantly slower, or -1 if the baseline couldn't be read.
+    s32 CompareToBaseline(IString path, const RunRecord& run);
+};
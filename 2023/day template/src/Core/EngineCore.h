@@ -60,6 +60,15 @@ StrPrintF(OUTPUT_BUFFER, OUTPUT_BUFFER_SIZE, format, __VA_ARGS__); \
 ErrPrint(OUTPUT_BUFFER);                                           \
 }
 
+// The print and assert macros call into the platform layer. Declare those functions here, so that Core
+// code (including templates, which need the names at definition time) can use them without Platform.h.
+namespace Platform
+{
+    void PrintMessage(const char* message);
+    void PrintError(const char* message);
+    bool ShowAssertDialog(const char* message);
+};
+
 // Assert macros.
 #ifndef NDEBUG
 #define Assert(x)                                                                                                      \
@@ -89,8 +98,19 @@ if (Platform::ShowAssertDialog(OUTPUT_BUFFER)) __debugbreak();
 #define AssertCustom(x, message)
 #endif // NDEBUG
 
+#include "Memory.h" // Before the containers, since it can replace their allocators.
 #include "MString.h"
 #include "TArray.h"
 
 
-#include "Span.h"
\ No newline at end of file
+#include "Span.h"
+#include "StringPool.h"
+#include "Simd.h"
+#include "Parse.h"
+#include "Lines.h"
+#include "Scan.h"
+#include "Records.h"
+#include "Arena.h"
+#include "Profile.h"
+#include "Bench.h"
+#include "Matcher.h"
\ No newline at end of file
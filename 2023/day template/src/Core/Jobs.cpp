@@ -0,0 +1,338 @@
+#include "Core/Jobs.h"
+#include "Platform/Platform.h"
+
+namespace JobsInternal
+{
+struct Job
+{
+    JobFunction* function;
+    void* data;
+    JobCounter* counter;
+};
+
+/**
+ * Chase-Lev deque with a fixed capacity. The owning worker pushes and pops at the bottom, and any other
+ * worker can steal from the top. The only contended case is a pop racing a steal for the last job, and
+ * that is settled with a compare exchange on top.
+ *
+ * Jobs are copied in and out by value. A thief reads its job before claiming it, and if the claim fails
+ * the copy is thrown away, so it doesn't matter if that read raced with the owner.
+ */
+struct Deque
+{
+    static constexpr s64 Capacity = 4096; // Must be a power of two.
+
+    Platform::Atomic<s64> top;
+    u8 padding[64 - sizeof(Platform::Atomic<s64>)]; // Keep thieves (on top) and the owner (on bottom) on separate cache lines.
+    Platform::Atomic<s64> bottom;
+    Job jobs[Capacity];
+
+    bool Push(Job job)
+    {
+        s64 b = bottom.Load();
+        s64 t = top.Load();
+        if (b - t >= Capacity) return false;
+        jobs[b & (Capacity - 1)] = job;
+        bottom.Store(b + 1);
+        return true;
+    }
+
+    bool Pop(Job* out_job)
+    {
+        // Exchange rather than Store, since we need a full barrier between publishing the new bottom and
+        // reading top. Otherwise a thief could take the same job we do.
+        s64 b = bottom.Load() - 1;
+        bottom.Exchange(b);
+        s64 t = top.Load();
+        if (t > b)
+        {
+            bottom.Store(b + 1); // Already empty.
+            return false;
+        }
+
+        *out_job = jobs[b & (Capacity - 1)];
+        if (t < b) return true; // More than one job left, so no thief can be after this one.
+
+        // Last job. Whoever moves top past it gets it.
+        bool result = top.CompareExchange(&t, t + 1);
+        bottom.Store(b + 1);
+        return result;
+    }
+
+    bool Steal(Job* out_job)
+    {
+        s64 t = top.Load();
+        s64 b = bottom.Load();
+        if (t >= b) return false;
+
+        *out_job = jobs[t & (Capacity - 1)];
+        return top.CompareExchange(&t, t + 1);
+    }
+};
+
+struct Worker
+{
+    Deque deque;
+    Platform::Thread thread;
+    s32 index;
+    u32 steal_from; // Where to start looking for work to steal, so thieves don't all pile onto the same victim.
+};
+
+struct Scheduler
+{
+    Worker* workers;
+    s32 worker_count;
+    u32 worker_slot; // Thread local slot holding the calling thread's Worker.
+
+    Platform::Atomic<u32> running;
+    Platform::Atomic<s32> sleeping; // Workers that are (about to be) waiting on wake.
+    Platform::Semaphore wake;
+};
+
+static Scheduler scheduler = {};
+
+static Worker* CurrentWorker()
+{
+    if (!scheduler.workers) return 0;
+    return (Worker*)Platform::GetThreadLocal(scheduler.worker_slot);
+}
+
+static void RunJob(Job job)
+{
+    job.function(job.data);
+    job.counter->remaining.FetchAdd(-1);
+}
+
+// Pops from our own deque first, since those jobs are the most recent (and the most likely to be in cache).
+// Failing that, goes looking through everyone else's.
+static bool FindJob(Worker* worker, Job* out_job)
+{
+    if (worker->deque.Pop(out_job)) return true;
+    for (s32 i = 1; i < scheduler.worker_count; ++i)
+    {
+        Worker* victim = &scheduler.workers[(worker->steal_from + i) % scheduler.worker_count];
+        if (victim == worker) continue;
+        if (victim->deque.Steal(out_job))
+        {
+            worker->steal_from = victim->index;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void WorkerMain(void* data)
+{
+    Worker* worker = (Worker*)data;
+    Platform::SetThreadLocal(scheduler.worker_slot, worker);
+
+    while (scheduler.running.Load())
+    {
+        Job job;
+        if (FindJob(worker, &job))
+        {
+            RunJob(job);
+            continue;
+        }
+
+        // Nothing to do. Announce that we're going to sleep before looking one last time, so that anyone
+        // who pushes a job after our last look is guaranteed to see us and wake us up.
+        scheduler.sleeping.FetchAdd(1);
+        if (FindJob(worker, &job))
+        {
+            scheduler.sleeping.FetchAdd(-1);
+            RunJob(job);
+            continue;
+        }
+        if (scheduler.running.Load()) scheduler.wake.Wait();
+        scheduler.sleeping.FetchAdd(-1);
+    }
+}
+} // namespace JobsInternal
+
+void Jobs::Start(s32 worker_count)
+{
+    using namespace JobsInternal;
+    Assert(!scheduler.workers); // Already started.
+    if (worker_count <= 0) worker_count = Platform::GetCoreCount();
+    if (worker_count < 1) worker_count = 1;
+
+    scheduler.workers = (Worker*)calloc(worker_count, sizeof(Worker)); // @malloc
+    scheduler.worker_count = worker_count;
+    scheduler.worker_slot = Platform::CreateThreadLocal();
+    scheduler.running.Store(1);
+    for (s32 i = 0; i < worker_count; ++i) scheduler.workers[i].index = i;
+
+    // The caller is worker 0.
+    Platform::SetThreadLocal(scheduler.worker_slot, &scheduler.workers[0]);
+    for (s32 i = 1; i < worker_count; ++i)
+    {
+        Worker* worker = &scheduler.workers[i];
+        worker->steal_from = (u32)i;
+        worker->thread = Platform::StartThread(WorkerMain, worker);
+        Assert(worker->thread.handle);
+    }
+}
+
+void Jobs::Stop()
+{
+    using namespace JobsInternal;
+    if (!scheduler.workers) return;
+
+    scheduler.running.Store(0);
+    scheduler.wake.Signal(scheduler.worker_count);
+    for (s32 i = 1; i < scheduler.worker_count; ++i) Platform::JoinThread(&scheduler.workers[i].thread);
+
+    Platform::FreeThreadLocal(scheduler.worker_slot);
+    free(scheduler.workers); // @malloc
+    scheduler = {};
+}
+
+s32 Jobs::WorkerCount()
+{
+    return JobsInternal::scheduler.workers ? JobsInternal::scheduler.worker_count : 1;
+}
+
+s32 Jobs::WorkerIndex()
+{
+    JobsInternal::Worker* worker = JobsInternal::CurrentWorker();
+    return worker ? worker->index : 0;
+}
+
+void Jobs::Spawn(JobCounter* counter, JobFunction* function, void* data)
+{
+    using namespace JobsInternal;
+    Assert(counter && function);
+    counter->remaining.FetchAdd(1);
+
+    Job job = {function, data, counter};
+    Worker* worker = CurrentWorker();
+    AssertCustom(worker || !scheduler.workers, "Jobs can only be spawned from worker threads.");
+
+    // No scheduler, or our deque is full. Either way, just do it now.
+    if (!worker || !worker->deque.Push(job))
+    {
+        RunJob(job);
+        return;
+    }
+
+    // FetchAdd(0) instead of Load(), for the full barrier. A plain load could be done before the push is
+    // visible, and miss a worker that went to sleep after its last look at our deque.
+    if (scheduler.sleeping.FetchAdd(0) > 0) scheduler.wake.Signal();
+}
+
+void Jobs::Wait(JobCounter* counter)
+{
+    using namespace JobsInternal;
+    Assert(counter);
+    Worker* worker = CurrentWorker();
+
+    // Rather than block, help out. Anything we can find to run gets us closer to being done (or at least
+    // keeps this core busy while someone else finishes our jobs).
+    while (counter->remaining.Load() > 0)
+    {
+        Job job;
+        if (worker && FindJob(worker, &job)) RunJob(job);
+        else Platform::YieldThread();
+    }
+}
+
+TArray<IString> Jobs::SplitLines(IString input, s64 chunk_size)
+{
+    Assert(chunk_size > 0);
+    TArray<IString> result = {};
+    s64 length = (s64)input.Length();
+    s64 start = 0;
+    while (start < length)
+    {
+        s64 end = start + chunk_size;
+        if (end >= length) end = length;
+        else
+        {
+            end = FindLineEnd(input, end - 1);
+            if (end < length) ++end; // Include the newline.
+        }
+        result.Append(IString(input.Ptr() + start, (MSTRING_SIZE_T)(end - start)));
+        start = end;
+    }
+    return result;
+}
+
+namespace JobsInternal
+{
+// Reads the rest of the next buffer, after the carried over bytes.
+static void ReadNextBlock(void* data)
+{
+    LineStream* stream = (LineStream*)data;
+    TArray<u8>& buffer = stream->buffers[stream->next];
+    stream->bytes_read = Platform::ReadFromFile(&stream->file, {buffer + stream->carried, buffer.Length() - stream->carried});
+}
+} // namespace JobsInternal
+
+bool LineStream::Open(IString path, s64 block_size)
+{
+    Assert(block_size > 0);
+    file = Platform::OpenFileReader(path);
+    if (!file.handle) return false;
+    // No point in buffers bigger than the file. One extra byte, so the first read can see the end of it.
+    if (block_size > file.size + 1) block_size = file.size + 1;
+    this->block_size = block_size;
+    buffers[0].SetLength((tarray_int)block_size);
+    buffers[1].SetLength((tarray_int)block_size);
+    Jobs::Spawn(&reading, JobsInternal::ReadNextBlock, this);
+    return true;
+}
+
+bool LineStream::Next(IString* out_block)
+{
+    for (;;)
+    {
+        Jobs::Wait(&reading);
+        if (bytes_read < 0) failed = true;
+        if (failed) return false;
+
+        u8* data = buffers[next];
+        s64 total = carried + bytes_read;
+        if (!bytes_read)
+        {
+            // End of the file. Whatever was carried over is the last line, and the next call finds nothing.
+            carried = 0;
+            if (!total) return false;
+            *out_block = {(const char*)data, (MSTRING_SIZE_T)total};
+            return true;
+        }
+
+        // The carried over bytes have no newline in them, so the last one (if any) is in what was just read.
+        s64 end = total;
+        while (end > carried && data[end - 1] != '\n') --end;
+        if (end == carried)
+        {
+            // Not even one whole line yet, so make room for more of it and keep reading into the same buffer.
+            carried = total;
+            buffers[next].SetLength((tarray_int)(total * 2));
+            Jobs::Spawn(&reading, JobsInternal::ReadNextBlock, this);
+            continue;
+        }
+
+        // Move the unfinished line at the end over to the other buffer, and start reading in after it. The
+        // other buffer held the previous block, which the caller is done with now.
+        s32 other = next ^ 1;
+        s64 tail = total - end;
+        if (buffers[other].Length() < tail + block_size) buffers[other].SetLength((tarray_int)(tail + block_size));
+        memcpy(buffers[other], data + end, tail);
+        carried = tail;
+        next = other;
+        Jobs::Spawn(&reading, JobsInternal::ReadNextBlock, this);
+
+        *out_block = {(const char*)data, (MSTRING_SIZE_T)end};
+        return true;
+    }
+}
+
+void LineStream::Close()
+{
+    Jobs::Wait(&reading);
+    Platform::CloseFileReader(&file);
+    buffers[0].Free();
+    buffers[1].Free();
+}
@@ -0,0 +1,105 @@
+#include "Core/Matcher.h"
+#include "Platform/Platform.h"
+
+s32 Matcher::FirstMatch(IString text, s64* out_offset) const
+{
+    const u16* table = next;
+    const s32* matches = match;
+    const u8* bytes = (const u8*)text.Ptr();
+    s64 length = (s64)text.Length();
+
+    s32 state = 0;
+    if (!reversed)
+    {
+        for (s64 i = 0; i < length; ++i)
+        {
+            state = table[state * 256 + bytes[i]];
+            if (matches[state] != NoMatch)
+            {
+                if (out_offset) *out_offset = i;
+                return matches[state];
+            }
+        }
+    }
+    else
+    {
+        for (s64 i = length - 1; i >= 0; --i)
+        {
+            state = table[state * 256 + bytes[i]];
+            if (matches[state] != NoMatch)
+            {
+                if (out_offset) *out_offset = i;
+                return matches[state];
+            }
+        }
+    }
+    return NoMatch;
+}
+
+Matcher BuildMatcher(Span<const IString> patterns, bool reversed)
+{
+    Matcher result = {};
+    result.reversed = reversed;
+
+    // There's at most one state per pattern byte, plus the start state, so the table never has to move.
+    s64 max_states = 1;
+    for (IString pattern : patterns) max_states += pattern.Length();
+    if (max_states > (s64)U16_MAX + 1) max_states = (s64)U16_MAX + 1;
+    result.next.SetCapacity((tarray_int)max_states * 256);
+    result.match.SetCapacity((tarray_int)max_states);
+
+    // Build the trie first. Nothing in a trie points back at the start state, so 0 can mean "no edge" for now.
+    result.next.SetLength(256);
+    result.match.Append(Matcher::NoMatch);
+    for (s64 p = 0; p < patterns.count; ++p)
+    {
+        IString pattern = patterns[p];
+        Assert(pattern.Length());
+        s32 state = 0;
+        for (s64 i = 0; i < (s64)pattern.Length(); ++i)
+        {
+            u8 byte = (u8)pattern[(reversed) ? pattern.Length() - 1 - i : i];
+            if (!result.next[state * 256 + byte])
+            {
+                s32 new_state = result.match.Length();
+                AssertCustom(new_state <= U16_MAX, "Too many patterns for a u16 transition table.");
+                result.next[state * 256 + byte] = (u16)new_state;
+                result.next.SetLength((new_state + 1) * 256);
+                result.match.Append(Matcher::NoMatch);
+            }
+            state = result.next[state * 256 + byte];
+        }
+        // Only a duplicate pattern can end in a state that already has one. Keep the first of them.
+        if (result.match[state] == Matcher::NoMatch) result.match[state] = (s32)p;
+    }
+
+    // Then fill in every missing edge breadth first, so a state's failure state (the longest proper suffix of
+    // it that is also in the trie) is always finished before the state itself. A missing edge goes wherever the
+    // failure state's edge goes, and a state with no match of its own reports its failure state's match,
+    // which is the longest pattern ending there.
+    s32 state_count = result.match.Length();
+    TArray<s32> failure = TArray<s32>(state_count);
+    TArray<s32> queue = {};
+    for (s32 byte = 0; byte < 256; ++byte)
+    {
+        s32 child = result.next[byte];
+        if (child) queue.Append(child); // Children of the start state fail back to it.
+    }
+    for (s32 head = 0; head < queue.Length(); ++head)
+    {
+        s32 state = queue[head];
+        s32 fail = failure[state];
+        if (result.match[state] == Matcher::NoMatch) result.match[state] = result.match[fail];
+        for (s32 byte = 0; byte < 256; ++byte)
+        {
+            s32 child = result.next[state * 256 + byte];
+            if (child)
+            {
+                failure[child] = result.next[fail * 256 + byte];
+                queue.Append(child);
+            }
+            else result.next[state * 256 + byte] = result.next[fail * 256 + byte];
+        }
+    }
+    return result;
+}
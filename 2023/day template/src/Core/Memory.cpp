@@ -0,0 +1,346 @@
+#include "Core/Memory.h"
+#include "Platform/Platform.h"
+
+#ifdef MEMORY_TRACKING_ENABLED
+namespace MemoryInternal
+{
+constexpr s32 MaxPrintedSites = 8;
+
+// One per live tracked block.
+struct Entry
+{
+    void* ptr; // Null for an empty slot.
+    s64 size;
+    Memory::Stats* owner; // Stats that were active when it was allocated, if any.
+};
+
+// Every live tracked block, keyed by address. Open addressing with linear probing. The entries come straight
+// from calloc, so the table doesn't track itself.
+struct Table
+{
+    Platform::Mutex lock; // Guards the table, and the counts in every Stats.
+    Entry* entries;
+    s64 capacity; // Always zero or a power of two.
+    s64 count;
+};
+
+static Table table = {};
+static thread_local Memory::Stats* thread_stats = nullptr;
+
+static s64 HomeSlot(const void* ptr)
+{
+    // Allocations are all 16-byte aligned, so mix the bits before masking (this is the MurmurHash3 finalizer).
+    u64 x = (u64)(uintptr_t)ptr;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return (s64)(x & (u64)(table.capacity - 1));
+}
+
+// The slot holding ptr, or the empty slot it would go in.
+static s64 FindSlot(const void* ptr)
+{
+    s64 slot = HomeSlot(ptr);
+    while (table.entries[slot].ptr && table.entries[slot].ptr != ptr) slot = (slot + 1) & (table.capacity - 1);
+    return slot;
+}
+
+static void Grow()
+{
+    Entry* old_entries = table.entries;
+    s64 old_capacity = table.capacity;
+    table.capacity = (old_capacity) ? old_capacity * 2 : 1024;
+    table.entries = (Entry*)calloc(table.capacity, sizeof(Entry)); // @malloc
+    for (s64 i = 0; i < old_capacity; ++i)
+    {
+        if (old_entries[i].ptr) table.entries[FindSlot(old_entries[i].ptr)] = old_entries[i];
+    }
+    free(old_entries); // @malloc
+}
+
+static void Insert(void* ptr, s64 size, Memory::Stats* owner)
+{
+    if ((table.count + 1) * 2 > table.capacity) Grow();
+    s64 slot = FindSlot(ptr);
+    if (!table.entries[slot].ptr) table.count += 1;
+    table.entries[slot] = {ptr, size, owner};
+}
+
+// Removes ptr from the table, and returns its entry (with a null ptr if it wasn't tracked).
+static Entry Remove(void* ptr)
+{
+    Entry result = {};
+    if (!table.count) return result;
+    s64 hole = FindSlot(ptr);
+    if (!table.entries[hole].ptr) return result;
+    result = table.entries[hole];
+    table.count -= 1;
+
+    // Shift later entries from the same run back into the hole, so lookups never stop early at an empty slot.
+    // An entry can't move if its home slot is (cyclically) after the hole, since it would then come before it.
+    s64 mask = table.capacity - 1;
+    for (s64 next = (hole + 1) & mask; table.entries[next].ptr; next = (next + 1) & mask)
+    {
+        s64 home = HomeSlot(table.entries[next].ptr);
+        bool stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!stays)
+        {
+            table.entries[hole] = table.entries[next];
+            hole = next;
+        }
+    }
+    table.entries[hole] = {};
+    return result;
+}
+
+// The call stack of an allocation, captured before taking the lock, and only if there are stats to count it in.
+struct CallStack
+{
+    void* frames[Memory::Site::MaxFrames];
+    s32 frame_count;
+};
+
+static CallStack CaptureCallStack()
+{
+    CallStack result = {};
+    result.frame_count = Platform::CaptureCallStack(result.frames, Memory::Site::MaxFrames);
+    return result;
+}
+
+// The last site is kept back as a catch-all, for when the table fills up.
+static Memory::Site* FindOrAddSite(Memory::Stats* stats, const CallStack& stack)
+{
+    for (s32 i = 0; i < stats->site_count; ++i)
+    {
+        Memory::Site* site = &stats->sites[i];
+        if (site->frame_count == stack.frame_count &&
+            memcmp(site->frames, stack.frames, stack.frame_count * sizeof(void*)) == 0) return site;
+    }
+    if (stats->site_count < Memory::Stats::MaxSites - 1)
+    {
+        Memory::Site* site = &stats->sites[stats->site_count++];
+        memcpy(site->frames, stack.frames, stack.frame_count * sizeof(void*));
+        site->frame_count = stack.frame_count;
+        return site;
+    }
+    stats->site_count = Memory::Stats::MaxSites;
+    return &stats->sites[Memory::Stats::MaxSites - 1];
+}
+
+static void AddLiveBytes(Memory::Stats* stats, s64 bytes)
+{
+    stats->live_bytes += bytes;
+    if (stats->live_bytes > stats->peak_bytes) stats->peak_bytes = stats->live_bytes;
+}
+
+// Functions that allocate on someone else's behalf. A site is reported as the first frame that isn't one of these.
+static const char* const AllocatorPrefixes[] = {
+    "Memory::", "MemoryInternal::", "TArray<", "MString::", "MStringInternal::", "Arena::", "StringPool::", "stbds_",
+    "Platform::ReadFileToBuffer",
+};
+
+static bool IsAllocatorFunction(const char* function)
+{
+    for (const char* prefix : AllocatorPrefixes)
+    {
+        if (strncmp(function, prefix, strlen(prefix)) == 0) return true;
+    }
+    return false;
+}
+
+// A site as it gets printed: resolved to its caller, and merged with any other sites that resolved to the same place.
+struct PrintedSite
+{
+    bool is_other; // The catch-all site, or a stack that couldn't be captured.
+    bool resolved; // False if there was no debug info, so there's no telling which frame was the caller.
+    Platform::CodeLocation location;
+    s64 allocations;
+    s64 reallocs;
+    s64 bytes_requested;
+    s64 bytes_copied;
+};
+
+static PrintedSite ResolveSite(const Memory::Site& site)
+{
+    PrintedSite result = {};
+    result.is_other = (site.frame_count == 0);
+    // If every frame is an allocator, the caller was further out than we captured, and the outermost one is kept.
+    for (s32 i = 0; i < site.frame_count; ++i)
+    {
+        result.resolved = Platform::DescribeCodeAddress(site.frames[i], &result.location);
+        if (!result.resolved || !IsAllocatorFunction(result.location.function)) break;
+    }
+    result.allocations = site.allocations;
+    result.reallocs = site.reallocs;
+    result.bytes_requested = site.bytes_requested;
+    result.bytes_copied = site.bytes_copied;
+    return result;
+}
+
+static bool IsSamePlace(const PrintedSite& a, const PrintedSite& b)
+{
+    if (a.is_other || b.is_other) return a.is_other == b.is_other;
+    if (!a.resolved || !b.resolved) return a.resolved == b.resolved;
+    return a.location.line == b.location.line && strcmp(a.location.function, b.location.function) == 0 &&
+           strcmp(a.location.file, b.location.file) == 0;
+}
+
+// Just the file name, since the full path doesn't fit on a line with everything else.
+static const char* FileName(const char* path)
+{
+    const char* result = path;
+    for (const char* c = path; *c; ++c) if (*c == '\\' || *c == '/') result = c + 1;
+    return result;
+}
+} // namespace MemoryInternal
+
+void* Memory::Allocate(size_t size)
+{
+    using namespace MemoryInternal;
+    void* result = malloc(size); // @malloc
+    if (!result) return result;
+
+    Stats* stats = thread_stats;
+    CallStack stack = (stats) ? CaptureCallStack() : CallStack{};
+    table.lock.Lock();
+    Insert(result, (s64)size, stats);
+    if (stats)
+    {
+        Site* site = FindOrAddSite(stats, stack);
+        stats->allocations += 1;
+        stats->bytes_requested += (s64)size;
+        site->allocations += 1;
+        site->bytes_requested += (s64)size;
+        AddLiveBytes(stats, (s64)size);
+    }
+    table.lock.Unlock();
+    return result;
+}
+
+void* Memory::Reallocate(void* ptr, size_t size)
+{
+    using namespace MemoryInternal;
+    if (!ptr) return Allocate(size);
+    if (!size)
+    {
+        Free(ptr);
+        return nullptr;
+    }
+
+    // Take the old block out before it can be freed, since another thread could get the same address back.
+    table.lock.Lock();
+    Entry old = Remove(ptr);
+    table.lock.Unlock();
+
+    void* result = realloc(ptr, size); // @malloc
+
+    Stats* stats = thread_stats;
+    CallStack stack = (stats && result) ? CaptureCallStack() : CallStack{};
+    table.lock.Lock();
+    if (!result)
+    {
+        if (old.ptr) Insert(old.ptr, old.size, old.owner); // The old block is still there.
+        table.lock.Unlock();
+        return result;
+    }
+    Insert(result, (s64)size, stats);
+    if (old.owner) AddLiveBytes(old.owner, -old.size);
+    if (stats)
+    {
+        // If the block moved, realloc copied everything that fit. We only know that if we tracked the old block.
+        s64 copied = (result != ptr && old.ptr) ? ((old.size < (s64)size) ? old.size : (s64)size) : 0;
+        Site* site = FindOrAddSite(stats, stack);
+        stats->reallocs += 1;
+        stats->bytes_requested += (s64)size;
+        stats->bytes_copied += copied;
+        site->reallocs += 1;
+        site->bytes_requested += (s64)size;
+        site->bytes_copied += copied;
+        AddLiveBytes(stats, (s64)size);
+    }
+    table.lock.Unlock();
+    return result;
+}
+
+void Memory::Free(void* ptr)
+{
+    using namespace MemoryInternal;
+    if (!ptr) return;
+
+    Stats* stats = thread_stats;
+    table.lock.Lock();
+    Entry entry = Remove(ptr);
+    if (entry.owner) AddLiveBytes(entry.owner, -entry.size);
+    if (stats) stats->frees += 1;
+    table.lock.Unlock();
+
+    free(ptr); // @malloc
+}
+
+Memory::Stats* Memory::SetThreadStats(Stats* stats)
+{
+    Stats* previous = MemoryInternal::thread_stats;
+    MemoryInternal::thread_stats = stats;
+    return previous;
+}
+
+void Memory::PrintStats(const char* name, const Stats* stats)
+{
+    using namespace MemoryInternal;
+    PrintF("%s: %lld allocations, %lld reallocs, %lld frees, %lld bytes requested, %lld bytes copied by realloc, peak %lld bytes live\n",
+           name, stats->allocations, stats->reallocs, stats->frees, stats->bytes_requested, stats->bytes_copied, stats->peak_bytes);
+
+    // Resolve every site to its caller, merging the ones that turn out to be the same place. That can be a
+    // while with a lot of symbols to load, but it's only done once the timing is over.
+    PrintedSite sites[Stats::MaxSites];
+    s32 site_count = 0;
+    for (s32 i = 0; i < stats->site_count; ++i)
+    {
+        PrintedSite site = ResolveSite(stats->sites[i]);
+        s32 j = 0;
+        while (j < site_count && !IsSamePlace(sites[j], site)) ++j;
+        if (j == site_count)
+        {
+            sites[site_count++] = site;
+            continue;
+        }
+        sites[j].allocations += site.allocations;
+        sites[j].reallocs += site.reallocs;
+        sites[j].bytes_requested += site.bytes_requested;
+        sites[j].bytes_copied += site.bytes_copied;
+    }
+
+    // Sort the sites by bytes requested, biggest first. There are only a few, so insertion sort is fine.
+    s32 order[Stats::MaxSites];
+    for (s32 i = 0; i < site_count; ++i)
+    {
+        s32 j = i;
+        for (; j > 0 && sites[order[j - 1]].bytes_requested < sites[i].bytes_requested; --j) order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    s32 shown = (site_count < MaxPrintedSites) ? site_count : MaxPrintedSites;
+    for (s32 i = 0; i < shown; ++i)
+    {
+        const PrintedSite& site = sites[order[i]];
+        PrintF("    %8lld allocs %8lld reallocs %12lld bytes %12lld copied  ", site.allocations, site.reallocs, site.bytes_requested, site.bytes_copied);
+        if (site.is_other)
+        {
+            PrintLog("(other sites)\n");
+        }
+        else if (!site.resolved)
+        {
+            PrintLog("(no debug info, build with /Z7)\n");
+        }
+        else if (site.location.line)
+        {
+            PrintF("%s (%s:%d)\n", site.location.function, FileName(site.location.file), site.location.line);
+        }
+        else
+        {
+            PrintF("%s\n", site.location.function);
+        }
+    }
+    if (site_count > shown) PrintF("    ... and %d more sites\n", site_count - shown);
+}
+#endif // MEMORY_TRACKING_ENABLED
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// Allocation tracking. When MEMORY_TRACKING_ENABLED is defined (see build.bat), TArray, MString, and the
+// other Core containers allocate through MEMORY_MALLOC/MEMORY_REALLOC/MEMORY_FREE, which count every call
+// into whichever Memory::Stats is active on the calling thread:
+//
+// Memory::Stats stats = {};
+// {
+//     MEMORY_TRACK_SCOPE(&stats);
+//     ... // Allocations made here (on this thread) are counted in stats.
+// }
+// Memory::PrintStats("Part 1", &stats);
+//
+// Stats keep totals (allocations, reallocs, frees, bytes requested, bytes copied when a realloc had to move,
+// and peak live bytes), and the same counts per call site. The call site is the code that asked the container
+// for memory, not the container itself: each allocation records its call stack, and PrintStats() reports the
+// first frame outside of Memory, TArray, MString, Arena, StringPool, and stb_ds. So every part's growth of the
+// same TArray shows up under the part's own function. Finding names and lines needs debug info (add /Z7), and
+// without it every site prints as one. In optimized builds, the containers get inlined into their callers,
+// so the line can point into the container's header, but the function is still the caller.
+//
+// Memory is tracked by its address rather than a header in front of it, so a tracked block can still be
+// given to plain free(). That just means the free isn't counted.
+//
+// Without MEMORY_TRACKING_ENABLED, the macros are plain malloc/realloc/free, MEMORY_TRACK_SCOPE() expands to
+// nothing, and the Memory namespace isn't declared at all, so calls to it need an #ifdef.
+
+#ifdef MEMORY_TRACKING_ENABLED
+namespace Memory
+{
+    struct Site
+    {
+        static constexpr s32 MaxFrames = 12; // Enough to get through the containers to whatever called them.
+
+        void* frames[MaxFrames]; // Return addresses, innermost first. Only resolved to names when printed.
+        s32 frame_count; // Zero for the catch-all site used once the table is full.
+        s64 allocations;
+        s64 reallocs;
+        s64 bytes_requested;
+        s64 bytes_copied;
+    };
+
+    struct Stats
+    {
+        static constexpr s32 MaxSites = 64;
+
+        s64 allocations; // Includes reallocs of a null pointer, which is what the containers do first.
+        s64 reallocs;
+        s64 frees;
+        s64 bytes_requested; // Sum of every size asked for, by allocations and reallocs.
+        s64 bytes_copied; // Bytes moved by reallocs that couldn't grow in place.
+        s64 live_bytes; // Allocated while these stats were active, and not freed yet (by any thread).
+        s64 peak_bytes;
+        Site sites[MaxSites]; // One per distinct call stack, so a few can print as the same site.
+        s32 site_count;
+    };
+
+    void* Allocate(size_t size);
+    void* Reallocate(void* ptr, size_t size);
+    void Free(void* ptr);
+
+    // Makes stats the active Stats for the calling thread, and returns the previous one. Allocations made while
+    // nothing is active are still tracked (so they can be freed correctly), they just aren't counted anywhere.
+    Stats* SetThreadStats(Stats* stats);
+
+    // Prints the totals, then the sites that requested the most bytes. Sites that resolve to the same function
+    // and line are merged first.
+    void PrintStats(const char* name, const Stats* stats);
+
+    struct StatsScope
+    {
+        Stats* previous;
+        StatsScope(Stats* stats) : previous(SetThreadStats(stats)) {}
+        ~StatsScope() {SetThreadStats(previous);}
+    };
+};
+
+#define MEMORY_MALLOC(size) Memory::Allocate((size))
+#define MEMORY_REALLOC(ptr, size) Memory::Reallocate((ptr), (size))
+#define MEMORY_FREE(ptr) Memory::Free((ptr))
+
+#define MEMORY_CONCAT_INTERNAL(a, b) a##b
+#define MEMORY_CONCAT(a, b) MEMORY_CONCAT_INTERNAL(a, b)
+#define MEMORY_TRACK_SCOPE(stats) Memory::StatsScope MEMORY_CONCAT(memory_scope_, __LINE__)(stats)
+
+// Route the single-header libraries through the tracked versions.
+#define TARRAY_MALLOC(size) MEMORY_MALLOC(size)
+#define TARRAY_REALLOC(old_ptr, size) MEMORY_REALLOC(old_ptr, size)
+#define TARRAY_FREE(ptr) MEMORY_FREE(ptr)
+#define MSTRING_MALLOC(size) MEMORY_MALLOC(size)
+#define MSTRING_REALLOC(old_ptr, size) MEMORY_REALLOC(old_ptr, size)
+#define MSTRING_FREE(ptr) MEMORY_FREE(ptr)
+#define STBDS_REALLOC(context, ptr, size) MEMORY_REALLOC(ptr, size)
+#define STBDS_FREE(context, ptr) MEMORY_FREE(ptr)
+#else
+#define MEMORY_MALLOC(size) malloc(size)
+#define MEMORY_REALLOC(ptr, size) realloc((ptr), (size))
+#define MEMORY_FREE(ptr) free(ptr)
+#define MEMORY_TRACK_SCOPE(stats)
+#endif // MEMORY_TRACKING_ENABLED
@@ -0,0 +1,183 @@
+#include "Core/Profile.h"
+#include "Platform/Platform.h"
+
+#ifdef PROFILE_ENABLED
+namespace ProfileInternal
+{
+constexpr s32 MaxThreads = 256;
+
+struct Registry
+{
+    Platform::Mutex lock;
+    Profile::ThreadBuffer* threads[MaxThreads];
+    s32 thread_count;
+
+    // TSC and wall clock at the first zone, so that we can work out the TSC frequency when we need it.
+    u64 start_ticks;
+    Platform::Timer timer;
+};
+
+static Registry registry = {};
+
+// One node per distinct path through the zones (so the same zone called from two places is two nodes).
+struct Node
+{
+    const char* name;
+    s32 parent;
+    s32 first_child;
+    s32 next_sibling;
+    u64 calls;
+    u64 total_ticks;
+    u64 self_ticks;
+};
+
+static s32 FindOrAddChild(TArray<Node>* nodes, s32 parent, const char* name)
+{
+    for (s32 child = (*nodes)[parent].first_child; child >= 0; child = (*nodes)[child].next_sibling)
+    {
+        if (strcmp((*nodes)[child].name, name) == 0) return child;
+    }
+    Node node = {name, parent, -1, (*nodes)[parent].first_child, 0, 0, 0};
+    s32 index = nodes->Append(node) - 1;
+    (*nodes)[parent].first_child = index;
+    return index;
+}
+
+static int CompareEvents(const void* p1, const void* p2)
+{
+    const Profile::Event* a = (const Profile::Event*)p1;
+    const Profile::Event* b = (const Profile::Event*)p2;
+    if (a->start != b->start) return (a->start < b->start) ? -1 : 1;
+    return (s32)a->depth - (s32)b->depth; // Parents first, if a child started on the same tick.
+}
+
+// The zones still in a thread's buffer, ordered by start time (so parents come before their children).
+static TArray<Profile::Event> SortedEvents(const Profile::ThreadBuffer* buffer)
+{
+    TArray<Profile::Event> result = {};
+    u64 first = (buffer->count > (u64)Profile::ThreadBuffer::Capacity) ? buffer->count - Profile::ThreadBuffer::Capacity : 0;
+    for (u64 i = first; i < buffer->count; ++i) result.Append(buffer->events[i & (Profile::ThreadBuffer::Capacity - 1)]);
+    if (result.Length()) qsort(&result[0], result.Length(), sizeof(Profile::Event), CompareEvents);
+    return result;
+}
+
+static double TicksPerMicrosecond()
+{
+    u64 ticks = __rdtsc() - registry.start_ticks;
+    u64 us = Platform::TimerCountsToMicroseconds(&registry.timer, Platform::TimerMeasureCounts(&registry.timer));
+    return (us) ? (double)ticks / (double)us : 1.0;
+}
+
+static void PrintNode(const TArray<Node>& nodes, s32 index, s32 depth, double ticks_per_ms)
+{
+    const Node& node = nodes[index];
+    PrintF("%*s%-*s %10llu %12.3f %12.3f\n", depth * 2, "", 40 - depth * 2, node.name, node.calls,
+           node.total_ticks / ticks_per_ms, node.self_ticks / ticks_per_ms);
+
+    // Children are stored newest first, so collect them and print in reverse for first-seen order.
+    TArray<s32> children = {};
+    for (s32 child = node.first_child; child >= 0; child = nodes[child].next_sibling) children.Append(child);
+    for (s32 i = children.Length() - 1; i >= 0; --i) PrintNode(nodes, children[i], depth + 1, ticks_per_ms);
+}
+
+// Appends text to a JSON string, escaping anything that would end it early.
+static void AppendJsonString(MString* out, const char* text)
+{
+    out->Append('"');
+    for (const char* c = text; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\') out->Append('\\');
+        out->Append(*c);
+    }
+    out->Append('"');
+}
+} // namespace ProfileInternal
+
+Profile::ThreadBuffer* Profile::CreateThreadBuffer()
+{
+    using namespace ProfileInternal;
+    ThreadBuffer* buffer = (ThreadBuffer*)malloc(sizeof(ThreadBuffer)); // @malloc
+    buffer->count = 0;
+    buffer->depth = 0;
+
+    registry.lock.Lock();
+    if (registry.thread_count == 0)
+    {
+        registry.start_ticks = __rdtsc();
+        Platform::TimerStart(&registry.timer);
+    }
+    AssertCustom(registry.thread_count < MaxThreads, "Too many threads recorded profiler zones.");
+    buffer->thread_index = (u32)registry.thread_count;
+    registry.threads[registry.thread_count++] = buffer;
+    registry.lock.Unlock();
+    return buffer;
+}
+
+void Profile::PrintSummary()
+{
+    using namespace ProfileInternal;
+    double ticks_per_ms = TicksPerMicrosecond() * 1000.0;
+
+    for (s32 thread = 0; thread < registry.thread_count; ++thread)
+    {
+        const ThreadBuffer* buffer = registry.threads[thread];
+        TArray<Event> events = SortedEvents(buffer);
+        if (!events.Length()) continue;
+
+        // Rebuild the nesting from the timestamps. Anything still on the stack that ended before this zone
+        // did can't be its parent. Parents that fell out of the ring buffer just make their children roots.
+        TArray<Node> nodes = {};
+        nodes.Append({"", -1, -1, -1, 0, 0, 0}); // Root.
+        struct Open {s32 node; u64 end;};
+        TArray<Open> stack = {};
+        for (const Event& event : events)
+        {
+            while (stack.Length() && stack[stack.Length() - 1].end < event.end) stack.SetLength(stack.Length() - 1);
+            s32 parent = (stack.Length()) ? stack[stack.Length() - 1].node : 0;
+            s32 index = FindOrAddChild(&nodes, parent, event.name);
+
+            u64 ticks = event.end - event.start;
+            nodes[index].calls += 1;
+            nodes[index].total_ticks += ticks;
+            nodes[index].self_ticks += ticks;
+            if (parent) nodes[parent].self_ticks -= ticks;
+
+            stack.Append({index, event.end});
+        }
+
+        PrintF("Thread %u%s:\n", buffer->thread_index, (buffer->count > (u64)ThreadBuffer::Capacity) ? " (oldest zones dropped)" : "");
+        PrintF("%-40s %10s %12s %12s\n", "Zone", "Calls", "Total (ms)", "Self (ms)");
+        TArray<s32> roots = {};
+        for (s32 child = nodes[0].first_child; child >= 0; child = nodes[child].next_sibling) roots.Append(child);
+        for (s32 i = roots.Length() - 1; i >= 0; --i) PrintNode(nodes, roots[i], 0, ticks_per_ms);
+    }
+}
+
+bool Profile::WriteChromeTrace(IString path)
+{
+    using namespace ProfileInternal;
+    double ticks_per_us = TicksPerMicrosecond();
+
+    // Complete ("X") events, in microseconds since the first zone. The viewer works out the nesting itself.
+    MString json = "{\"traceEvents\":[\n";
+    char number_buffer[128];
+    bool first = true;
+    for (s32 thread = 0; thread < registry.thread_count; ++thread)
+    {
+        const ThreadBuffer* buffer = registry.threads[thread];
+        TArray<Event> events = SortedEvents(buffer);
+        for (const Event& event : events)
+        {
+            if (!first) json.Append(",\n");
+            first = false;
+            json.Append("{\"name\":");
+            AppendJsonString(&json, event.name);
+            StrPrintF(number_buffer, sizeof(number_buffer), ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                      buffer->thread_index, (event.start - registry.start_ticks) / ticks_per_us, (event.end - event.start) / ticks_per_us);
+            json.Append(number_buffer);
+        }
+    }
+    json.Append("\n]}\n");
+    return Platform::WriteBufferToFile(path, {(const u8*)json.Ptr(), (s64)json.Length()});
+}
+#endif // PROFILE_ENABLED
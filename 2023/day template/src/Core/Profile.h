@@ -0,0 +1,89 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// Scoped profiler zones. PROFILE_SCOPE("name") times everything from that line to the end of the enclosing
+// scope, and zones nest, so a zone inside another one shows up as its child:
+//
+// static s64 DoPartOne(const ParsedInput& input, Arena* scratch)
+// {
+//     PROFILE_SCOPE("Build graph");
+//     ...
+// }
+//
+// Zones are written to a ring buffer owned by the thread they ran on, so recording one is two timestamp
+// reads and a store, with no locking. Each buffer keeps the most recent ThreadBuffer::Capacity zones.
+// Afterwards, Profile::PrintSummary() prints a call tree per thread (calls, total and self time), and
+// Profile::WriteChromeTrace() writes JSON that chrome://tracing or ui.perfetto.dev can open.
+//
+// All of this only exists when PROFILE_ENABLED is defined (see build.bat). Otherwise PROFILE_SCOPE()
+// expands to nothing, and the Profile namespace isn't declared at all, so calls to it need an #ifdef.
+
+#ifdef PROFILE_ENABLED
+#if defined _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+namespace Profile
+{
+    struct Event
+    {
+        const char* name;
+        u64 start; // Timestamps are raw TSC ticks. They only get converted when we write results out.
+        u64 end;
+        u32 depth; // Number of zones this one is nested inside (on the same thread).
+    };
+
+    struct ThreadBuffer
+    {
+        static constexpr s64 Capacity = 1 << 16; // Must be a power of two.
+
+        Event events[Capacity];
+        u64 count; // Zones recorded so far. The newest one is at events[(count - 1) % Capacity].
+        u32 depth;
+        u32 thread_index; // Order the threads first recorded something in, starting at 0.
+    };
+
+    ThreadBuffer* CreateThreadBuffer(); // Allocates and registers a buffer for the calling thread.
+
+    inline ThreadBuffer* GetThreadBuffer()
+    {
+        static thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) buffer = CreateThreadBuffer();
+        return buffer;
+    }
+
+    struct Zone
+    {
+        ThreadBuffer* buffer;
+        const char* name;
+        u64 start;
+
+        Zone(const char* name) : buffer(GetThreadBuffer()), name(name)
+        {
+            buffer->depth += 1;
+            start = __rdtsc();
+        }
+
+        ~Zone()
+        {
+            u64 end = __rdtsc();
+            buffer->depth -= 1;
+            buffer->events[buffer->count & (ThreadBuffer::Capacity - 1)] = {name, start, end, buffer->depth};
+            buffer->count += 1;
+        }
+    };
+
+    // Both of these read every thread's buffer, so only call them once the other threads have stopped recording.
+    void PrintSummary();
+    bool WriteChromeTrace(IString path);
+};
+
+#define PROFILE_CONCAT_INTERNAL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INTERNAL(a, b)
+#define PROFILE_SCOPE(name) Profile::Zone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif // PROFILE_ENABLED
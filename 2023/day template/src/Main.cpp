@@ -1,45 +1,182 @@
-
 #include "Core/EngineCore.h"
 #include "Platform/Platform.h"
 
 #define DEFAULT_INPUT_PATH "input.txt"
+#define DAY_NAME "template" // Identifies these results in saved benchmarks.
+
+// Everything both parts need from the input. Parse() builds it once, and the parts only ever read it,
+// which is what lets them run at the same time. Days that don't need a real parse can leave this as the text.
+// The input itself is read-only (it may be a mapped file), so anything a part needs to modify, it copies into
+// its scratch arena first.
+struct ParsedInput
+{
+    Span<const char> text;
+};
 
-static s64 DoPartOne(Span<char> input)
+static ParsedInput Parse(Span<const char> input)
+{
+    ParsedInput result = {};
+    result.text = input;
+    return result;
+}
+
+static s64 DoPartOne(const ParsedInput& input, Arena* scratch)
 {
     return -1;
 }
 
-static s64 DoPartTwo(Span<char> input)
+static s64 DoPartTwo(const ParsedInput& input, Arena* scratch)
 {
     return -1;
 }
 
+typedef s64 PartFunction(const ParsedInput& input, Arena* scratch);
+
+struct PartRun
+{
+    const char* name;
+    PartFunction* function;
+    const ParsedInput* input;
+    s64 result;
+    TArray<u64> samples_us; // One per run. Reserved up front, so recording them isn't counted as the part allocating.
+    Arena scratch; // Each part gets its own, so they don't need to share an allocator when running concurrently.
+#ifdef MEMORY_TRACKING_ENABLED
+    Memory::Stats memory;
+#endif
+};
+
+// Runs and times one part. Takes a void* so that it can also be a thread's entry point.
+static void RunPart(void* data)
+{
+    PartRun* run = (PartRun*)data;
+    PROFILE_SCOPE(run->name);
+    MEMORY_TRACK_SCOPE(&run->memory);
+    run->scratch.Reset();
+    Platform::Timer timer = {};
+    Platform::TimerStart(&timer);
+    run->result = run->function(*run->input, &run->scratch);
+    run->samples_us.Append(Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer)));
+}
+
 int main(int argc, char* argv[])
 {
-    // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
-    Span<u8> input_file = Platform::ReadFileToBuffer(path);
+    // Arguments are the input path (optional), and any of:
+    // --concurrent      Run the two parts at the same time.
+    // --runs N          Run parsing and both parts N times, and report the median times.
+    // --json PATH       Write the results, with every timing sample, to PATH.
+    // --history PATH    Append a line per part to the CSV file at PATH.
+    // --compare PATH    Compare against results written with --json, and flag significant changes.
+    IString path = DEFAULT_INPUT_PATH;
+    bool concurrent = false;
+    s32 runs = 1;
+    const char* json_path = nullptr;
+    const char* history_path = nullptr;
+    const char* baseline_path = nullptr;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "--concurrent") concurrent = true;
+        else if (arg == "--runs" && has_value) runs = atoi(argv[++i]);
+        else if (arg == "--json" && has_value) json_path = argv[++i];
+        else if (arg == "--history" && has_value) history_path = argv[++i];
+        else if (arg == "--compare" && has_value) baseline_path = argv[++i];
+        else path = arg;
+    }
+    if (runs < 1) runs = 1;
+
+    // Map the input file. Parsing and both parts all read from the one copy.
+    Span<const u8> input_file = Platform::MapFile(path);
 
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s64 part1 = DoPartOne({(char*)input_file.ptr, input_file.count});
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    // Parse once per run, for both parts. The parts all use the last one.
+#ifdef MEMORY_TRACKING_ENABLED
+    Memory::Stats parse_memory = {};
+#endif
+    TArray<u64> parse_samples_us = {};
+    parse_samples_us.SetCapacity(runs);
+    ParsedInput parsed = {};
+    for (s32 run = 0; run < runs; ++run)
+    {
+        PROFILE_SCOPE("Parse");
+        MEMORY_TRACK_SCOPE(&parse_memory);
+        Platform::Timer parse_timer = {};
+        Platform::TimerStart(&parse_timer);
+        parsed = Parse({(const char*)input_file.ptr, input_file.count});
+        parse_samples_us.Append(Platform::TimerCountsToMicroseconds(&parse_timer, Platform::TimerMeasureCounts(&parse_timer)));
+    }
 
-    s64 part2 = DoPartTwo({(char*)input_file.ptr, input_file.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+    // Do the actual work. Concurrently, part two gets a thread of its own while part one runs on this one.
+    PartRun part1 = {"Part 1", DoPartOne, &parsed};
+    PartRun part2 = {"Part 2", DoPartTwo, &parsed};
+    part1.samples_us.SetCapacity(runs);
+    part2.samples_us.SetCapacity(runs);
+    for (s32 run = 0; run < runs; ++run)
+    {
+        if (concurrent)
+        {
+            Platform::Thread thread = Platform::StartThread(RunPart, &part2);
+            AssertCustom(thread.handle, "Failed to start a thread for part two.");
+            RunPart(&part1);
+            Platform::JoinThread(&thread);
+        }
+        else
+        {
+            RunPart(&part1);
+            RunPart(&part2);
+        }
+    }
+    u64 total_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
-
-    // Print results.
-    PrintF("Part 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
-    // Free the input file and exit.
-    free(input_file.ptr);
-    return 0;
-}
+    u64 total_us = Platform::TimerCountsToMicroseconds(&timer, total_counts) / runs;
+    Bench::Stats parse_stats = Bench::Summarize({parse_samples_us.begin(), parse_samples_us.Length()});
+    Bench::Stats part1_stats = Bench::Summarize({part1.samples_us.begin(), part1.samples_us.Length()});
+    Bench::Stats part2_stats = Bench::Summarize({part2.samples_us.begin(), part2.samples_us.Length()});
 
+    // Print results. With more than one run, the times are medians, and the total is the average per run.
+    PrintF("Parsed in %lldus\nPart 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\nTotal: %lldus%s\n",
+           parse_stats.median, part1.result, part1_stats.median, part2.result, part2_stats.median, total_us, concurrent ? " (parts ran concurrently)" : "");
+    if (runs > 1) PrintF("Times are medians of %d runs.\n", runs);
+#ifdef MEMORY_TRACKING_ENABLED
+    PrintLog("\n");
+    Memory::PrintStats("Parse", &parse_memory);
+    Memory::PrintStats(part1.name, &part1.memory);
+    Memory::PrintStats(part2.name, &part2.memory);
+#endif
+#ifdef PROFILE_ENABLED
+    PrintLog("\n");
+    Profile::PrintSummary();
+    if (Profile::WriteChromeTrace("profile.json")) PrintLog("Wrote profile.json (open it in chrome://tracing or ui.perfetto.dev).\n");
+#endif
 
+    // Record the results, and check them against a baseline, if asked to.
+    Bench::PartRecord parts[] =
+    {
+        {"Parse", 0, {parse_samples_us.begin(), parse_samples_us.Length()}},
+        {part1.name, part1.result, {part1.samples_us.begin(), part1.samples_us.Length()}},
+        {part2.name, part2.result, {part2.samples_us.begin(), part2.samples_us.Length()}},
+    };
+#ifdef MEMORY_TRACKING_ENABLED
+    parts[0].memory = &parse_memory;
+    parts[1].memory = &part1.memory;
+    parts[2].memory = &part2.memory;
+#endif
+    Bench::RunRecord record = {DAY_NAME, Bench::HashInput(input_file), GIT_REVISION, Platform::CpuName(), concurrent, parts};
+    s32 exit_code = 0;
+    if (json_path && !Bench::WriteJson(json_path, record)) ErrPrintF("Failed to write results to %s.\n", json_path);
+    if (history_path && !Bench::AppendHistory(history_path, record)) ErrPrintF("Failed to append results to %s.\n", history_path);
+    if (baseline_path)
+    {
+        s32 regressions = Bench::CompareToBaseline(baseline_path, record);
+        if (regressions < 0) ErrPrintF("Failed to read the baseline from %s.\n", baseline_path);
+        if (regressions) exit_code = 1; // So scripts can use this as a gate.
+    }
+
+    // Unmap the input file and exit.
+    Platform::UnmapFile(input_file);
+    return exit_code;
+}
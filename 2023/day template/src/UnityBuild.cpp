@@ -2,5 +2,15 @@
 #include "Core/EngineCore.h"
 
 #include "Core/EngineCore.cpp"
+#include "Core/Memory.cpp"
+#include "Core/StringPool.cpp"
+#include "Core/Simd.cpp"
+#include "Core/Parse.cpp"
+#include "Core/Lines.cpp"
+#include "Core/Jobs.cpp"
+#include "Core/Arena.cpp"
+#include "Core/Profile.cpp"
+#include "Core/Bench.cpp"
+#include "Core/Matcher.cpp"
 #include "Platform/Platform.cpp"
 #include "Main.cpp"
\ No newline at end of file
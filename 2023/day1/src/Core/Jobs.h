@@ -0,0 +1,173 @@
+#pragma once
+
+#include "EngineCore.h"
+#include "Platform/Platform.h"
+
+// Work-stealing job system. Each worker thread owns a deque of jobs: it pushes and pops its own jobs
+// at the bottom, and idle workers steal from the top of everyone else's (Chase-Lev). The thread that
+// calls Jobs::Start() becomes worker 0, and helps run jobs whenever it waits on them.
+//
+// This sits on top of the platform threads, so it isn't included by EngineCore.h. Include Core/Jobs.h
+// where you need it.
+//
+// Jobs::Start();
+// JobCounter counter = {};
+// Jobs::Spawn(&counter, SomeFunction, &some_data);
+// Jobs::Wait(&counter); // Runs jobs (ours or stolen ones) until everything spawned on counter is done.
+//
+// If the scheduler was never started, Spawn() just runs the job immediately, so code written against
+// this still works (single threaded) without it.
+
+typedef void JobFunction(void* data);
+
+// Counts outstanding jobs. Zero initialize it, spawn jobs against it, then wait on it.
+struct JobCounter
+{
+    Platform::Atomic<s64> remaining;
+};
+
+namespace Jobs
+{
+    // Starts worker_count - 1 threads (the caller is the last worker). Zero means one per logical core.
+    void Start(s32 worker_count = 0);
+    void Stop(); // Waits for the workers to finish what they're doing, then shuts them down.
+
+    s32 WorkerCount(); // 1 if the scheduler isn't running.
+    s32 WorkerIndex(); // Index of the calling worker, in [0, WorkerCount()).
+
+    void Spawn(JobCounter* counter, JobFunction* function, void* data);
+    void Wait(JobCounter* counter);
+
+    // Splits the input into chunks of roughly chunk_size bytes. Every chunk except the last ends just after
+    // a newline, so no line is ever split between two chunks. The chunks cover the whole input, in order.
+    TArray<IString> SplitLines(IString input, s64 chunk_size);
+};
+
+namespace JobsInternal
+{
+// Fork/join over [begin, end): big ranges split in half, spawning the second half for someone to steal and
+// carrying on with the first, until the pieces are no bigger than the grain.
+template <typename Range> struct RangeJob
+{
+    Range* range;
+    s64 begin;
+    s64 end;
+
+    static void Run(void* data)
+    {
+        RangeJob job = *(RangeJob*)data;
+        JobCounter counter = {};
+        RangeJob halves[64]; // Each split halves the range, so this is as deep as it can go.
+        s32 half_count = 0;
+        while (job.end - job.begin > job.range->grain)
+        {
+            s64 middle = job.begin + (job.end - job.begin) / 2;
+            halves[half_count] = {job.range, middle, job.end};
+            Jobs::Spawn(&counter, Run, &halves[half_count++]);
+            job.end = middle;
+        }
+        job.range->Execute(job.begin, job.end);
+        Jobs::Wait(&counter);
+    }
+};
+
+template <typename T, typename F> struct ForRange
+{
+    Span<T> items;
+    s64 grain;
+    F* function;
+
+    void Execute(s64 begin, s64 end) {(*function)(items.SubSpan(begin, end - begin));}
+};
+
+// Accumulators are padded out to a cache line each, so workers adding to their own don't fight over the
+// same line. Padded rather than alignas(64), since TArray memory only has malloc alignment.
+template <typename A> struct Accumulator
+{
+    A value;
+    u8 padding[64 - sizeof(A) % 64];
+};
+
+template <typename T, typename A, typename F> struct ReduceRange
+{
+    Span<T> items;
+    s64 grain;
+    F* function;
+    Accumulator<A>* accumulators;
+
+    void Execute(s64 begin, s64 end) {(*function)(items.SubSpan(begin, end - begin), &accumulators[Jobs::WorkerIndex()].value);}
+};
+
+template <typename Range> void RunRange(Range* range, s64 count)
+{
+    if (count <= 0) return;
+    if (range->grain < 1) range->grain = 1;
+    RangeJob<Range> root = {range, 0, count};
+    RangeJob<Range>::Run(&root);
+}
+} // namespace JobsInternal
+
+/**
+ * Calls function(Span<T> chunk) over the items, in chunks of at most grain items, spread across the workers.
+ * Returns once every chunk is done. Chunks run in no particular order, and possibly at the same time, so
+ * the function must only touch its own chunk (or synchronize).
+ */
+template <typename T, typename F> void ParallelFor(Span<T> items, s64 grain, F function)
+{
+    JobsInternal::ForRange<T, F> range = {items, grain, &function};
+    JobsInternal::RunRange(&range, items.count);
+}
+
+/**
+ * Like ParallelFor, but each chunk adds into an accumulator: function(Span<T> chunk, A* accumulator).
+ * There is one accumulator per worker (starting out as identity), so chunks never share one, and
+ * combine(A* result, A value) folds them together at the end. Returns the combined result.
+ *
+ * s64 total = ParallelReduce(lines, 64, (s64)0, [](Span<IString> chunk, s64* sum) {...}, [](s64* a, s64 b) {*a += b;});
+ */
+template <typename T, typename A, typename F, typename C> A ParallelReduce(Span<T> items, s64 grain, A identity, F function, C combine)
+{
+    s32 worker_count = Jobs::WorkerCount();
+    TArray<JobsInternal::Accumulator<A>> accumulators = {};
+    accumulators.SetLength(worker_count);
+    for (JobsInternal::Accumulator<A>& accumulator : accumulators) accumulator.value = identity;
+
+    JobsInternal::ReduceRange<T, A, F> range = {items, grain, &function, &accumulators[0]};
+    JobsInternal::RunRange(&range, items.count);
+
+    A result = identity;
+    for (JobsInternal::Accumulator<A>& accumulator : accumulators) combine(&result, accumulator.value);
+    return result;
+}
+
+/**
+ * Streams a file through memory in blocks of whole lines, for inputs too big to read (or map) all at once.
+ * While the caller works on one block, a job reads the next one into a second buffer:
+ *
+ * LineStream stream = {};
+ * if (stream.Open(path, 16 << 20))
+ * {
+ *     IString block;
+ *     while (stream.Next(&block)) {...} // A block is only valid until the next call to Next().
+ *     stream.Close();
+ * }
+ *
+ * Blocks are about block_size bytes, and end just after a newline (except for the last one), so every line
+ * arrives whole. A line longer than block_size still does, the buffers just grow to fit it. Check failed
+ * afterwards to tell a read error apart from the end of the file.
+ */
+struct LineStream
+{
+    Platform::FileReader file;
+    TArray<u8> buffers[2];
+    s32 next; // Buffer the next block comes out of, and the read in flight is going into.
+    s64 carried; // Bytes at the start of buffers[next] left over from the last block (the start of an unfinished line).
+    s64 block_size;
+    s64 bytes_read; // Set by the read in flight, see Platform::ReadFromFile().
+    JobCounter reading;
+    bool failed;
+
+    bool Open(IString path, s64 block_size);
+    bool Next(IString* out_block);
+    void Close(); // Waits for the read in flight (if there is one), then closes the file and frees the buffers.
+};
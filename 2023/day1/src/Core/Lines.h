@@ -0,0 +1,48 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// Line handling for text inputs. Lines end in '\n', and the last line doesn't need one. A newline at the
+// very end of the input doesn't start another (empty) line, so "a\nb" and "a\nb\n" both have two lines.
+//
+// Newlines are found with the best SIMD backend the CPU supports (see Simd.h), up to 64 bytes at a time.
+
+// Offset of the first '\n' at or after offset, or input.Length() if there isn't one.
+s64 FindLineEnd(IString input, s64 offset);
+
+s64 CountLines(IString input);
+
+// Width of the lines (not counting the newline) if every line is the same width, or -1 if they aren't.
+// Text grids can use width + 1 as the row stride.
+s64 UniformLineWidth(IString input);
+
+/**
+ * Offset of the start of every line in the input, built in a single pass. Once it is built you can jump
+ * straight to any line without rescanning, which also makes it easy to hand out ranges of lines to
+ * different threads. Offsets are stored as u32 to keep the index small, so the input can be at most 4 GiB
+ * (BuildLineIndex() asserts that).
+ */
+struct LineIndex
+{
+    IString input;
+    TArray<u32> starts;
+
+    s64 Count() const {return starts.Length();}
+    IString operator[](s64 line) const; // The line, without its newline.
+};
+
+LineIndex BuildLineIndex(IString input);
+
+/**
+ * Walks the lines of the input one at a time, without building an index first:
+ * LineIterator it = {input};
+ * IString line;
+ * while (it.Next(&line)) {...}
+ */
+struct LineIterator
+{
+    IString input;
+    s64 offset;
+
+    bool Next(IString* out_line);
+};
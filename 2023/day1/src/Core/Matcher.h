@@ -0,0 +1,43 @@
+#pragma once
+
+#include "EngineCore.h"
+
+/**
+ * Multi-pattern string matcher: an Aho-Corasick automaton, compiled down to a dense DFA. Every state has
+ * a transition for all 256 byte values (failure links are already folded in), so matching is exactly one
+ * table lookup per byte, no matter how many patterns there are or how they overlap:
+ *
+ * IString patterns[] = {"one", "two", "three"};
+ * Matcher matcher = BuildMatcher(patterns);
+ * s32 found = matcher.FirstMatch(text); // 0, 1, 2, or Matcher::NoMatch.
+ *
+ * A forward matcher completes a match at its last byte, so FirstMatch() finds the match that ends first.
+ * A reversed matcher matches the patterns spelled backwards, and FirstMatch() on one scans from the end of
+ * the text towards the start. It completes a match at its first byte, so it finds the match that starts
+ * last. Between the two, you can find the first and last match in a string while only touching the bytes
+ * up to each of them.
+ *
+ * If more than one pattern is completed at the same byte, the longest one is reported. The table is 512 bytes per
+ * state, and there is one state per distinct pattern prefix, so this is meant for small pattern sets.
+ */
+struct Matcher
+{
+    constexpr static s32 NoMatch = -1;
+
+    TArray<u16> next; // Transition table, indexed by state * 256 + byte. State 0 is the start state.
+    TArray<s32> match; // Per state, the pattern that ends there (if any).
+    bool reversed;
+
+    s64 StateCount() const {return match.Length();}
+
+    inline s32 Step(s32 state, u8 byte) const {return next[state * 256 + byte];}
+
+    // Index of the first pattern completed, scanning in this matcher's direction, or NoMatch. That's the match
+    // that ends first for a forward matcher, and the one that starts last for a reversed one. Stops as soon as
+    // one is found. If out_offset isn't null, it gets the offset in text where the match was completed (its
+    // last byte going forward, or its first byte in reverse).
+    s32 FirstMatch(IString text, s64* out_offset = nullptr) const;
+};
+
+// Patterns must not be empty. They may repeat or overlap each other however they like.
+Matcher BuildMatcher(Span<const IString> patterns, bool reversed = false);
@@ -1,112 +1,209 @@
 
 #include "Core/EngineCore.h"
 #include "Platform/Platform.h"
+#include "Core/Jobs.h"
 
 #define DEFAULT_INPUT_PATH "input.txt"
 
-// Returns a digit at the current offset if we were able to parse one, or -1 otherwise.
-char ParseDigit(IString input, s32 offset)
+constexpr s64 ChunksPerWorker = 4;
+constexpr s64 MinChunkSize = 64 << 10;
+constexpr s64 StreamBlockSize = 64 << 20;
+
+// Part one only cares about the first and last digit of each line, so instead of walking the bytes, we
+// build a digit mask and a newline mask for each 64 byte block, and read the digits straight out of them:
+// the first digit of a line is the lowest digit bit after the previous newline, and the last is the highest
+// digit bit before the next one. That's a couple of bit scans per line, and no per-byte branches.
+struct CalibrationSum
 {
-    // Check for literal digits.
-    if (input[offset] >= '0' && input[offset] <= '9') return input[offset] - '0';
+    // The line being scanned can span any number of blocks.
+    struct LineState
+    {
+        s64 sum;
+        s32 first; // -1 until the line has a digit.
+        s32 last;
+    };
+
+    static void AddDigits(const char* block, u64 digits, LineState* state)
+    {
+        if (!digits) return;
+        if (state->first < 0) state->first = block[Simd::CountTrailingZeros(digits)] - '0';
+        state->last = block[63 - Simd::CountLeadingZeros(digits)] - '0';
+    }
 
-    // Check for digit substrings.
-    static IString lut[] = {"zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
-    for (s32 i = 0; i < ARRAYCOUNT(lut); ++i)
+    template <typename Backend> static void ScanBlock(const char* block, LineState* state)
     {
-        if (offset + lut[i].Length() <= input.Length())
+        using U8 = typename Backend::U8;
+        U8 zero = U8::Splat('0');
+        U8 nine = U8::Splat(9);
+        U8 newline = U8::Splat('\n');
+
+        u64 digits = 0;
+        u64 newlines = 0;
+        for (s64 i = 0; i < 64; i += U8::lanes)
         {
-            // If we found a substring, use it and return.
-            if (memcmp(&input[offset], lut[i].Ptr(), lut[i].Length()) == 0) return i;
+            U8 bytes = U8::Load(block + i);
+            U8 value = bytes - zero; // Digits become 0-9, and everything else wraps to something bigger.
+            digits |= MoveMask(Equal(Min(value, nine), value)) << i;
+            newlines |= MoveMask(Equal(bytes, newline)) << i;
         }
-    }
 
-    // No digit found.
-    return -1;
-}
+        while (newlines)
+        {
+            s32 end = Simd::CountTrailingZeros(newlines);
+            u64 before_end = (1ull << end) - 1;
+            AddDigits(block, digits & before_end, state);
+            if (state->first >= 0) state->sum += state->first * 10 + state->last;
+            state->first = -1;
+            digits &= ~before_end;
+            newlines &= newlines - 1;
+        }
+        AddDigits(block, digits, state); // Whatever is left belongs to a line that continues into the next block.
+    }
 
-static s32 DoPartOne(IString input)
-{
-    s32 result = 0;
-    // Scan each line.
-    s32 file_offset = 0;
-    for (s32 file_offset = 0; file_offset < input.Length(); ++file_offset)
+    template <typename Backend> static s64 Run(const char* ptr, s64 length)
     {
-        s32 first_digit = -1; // First digit, or -1 if we haven't found a digit yet.
-        s32 last_digit = 0;
+        LineState state = {0, -1, 0};
+        s64 offset = 0;
+        for (; offset + 64 <= length; offset += 64) ScanBlock<Backend>(ptr + offset, &state);
 
-        char c = input[file_offset];
-        while (c != '\n' && file_offset < input.Length())
+        // Pad the last partial block with zeros, which are neither digits nor newlines.
+        if (offset < length)
         {
-            char digit = c - '0';
-            if (digit >= 0 && digit <= 9)
-            {
-                if (first_digit < 0) first_digit = digit;
-                last_digit = digit;
-            }
-
-            ++file_offset;
-            if (file_offset < input.Length()) c = input[file_offset];
+            char tail[64] = {};
+            memcpy(tail, ptr + offset, length - offset);
+            ScanBlock<Backend>(tail, &state);
         }
 
-        result += (first_digit * 10) + last_digit;
+        // The last line doesn't need a newline.
+        if (state.first >= 0) state.sum += state.first * 10 + state.last;
+        return state.sum;
     }
-    return result;
+};
+
+static s64 DoPartOne(IString input)
+{
+    return Simd::Dispatch<CalibrationSum>(input.Ptr(), (s64)input.Length());
 }
 
-static s32 DoPartTwo(IString input)
+// Part two also counts spelled out digits, which can overlap ("twone"). All twenty patterns are compiled into
+// one automaton for the first digit, and another over the reversed patterns that reads each line backwards
+// from its end for the last digit. That's one table lookup per byte, and both scans stop at their first
+// match, so the middle of a line is only ever seen by the newline search.
+struct DigitMatchers
 {
-    IString lut[] = {"zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
+    Matcher forward;
+    Matcher backward;
+};
 
-    s32 result = 0;
-    // Scan each line.
-    s32 file_offset = 0;
-    for (s32 file_offset = 0; file_offset < input.Length(); ++file_offset)
-    {
-        s32 first_digit = -1; // First digit, or -1 if we haven't found a digit yet.
-        s32 last_digit = 0;
+static DigitMatchers BuildDigitMatchers()
+{
+    // Pattern i is worth i % 10.
+    static IString digits[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+                               "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
+    return {BuildMatcher(digits), BuildMatcher(digits, true)};
+}
 
-        while (input[file_offset] != '\n' && file_offset < input.Length())
-        {
-            char digit = ParseDigit(input, file_offset);
-
-            if (digit >= 0)
-            {
-                if (first_digit < 0) first_digit = digit;
-                last_digit = digit;
-            }
-            ++file_offset;
-        }
+static s64 DoPartTwo(IString input, const DigitMatchers& matchers)
+{
+    s64 result = 0;
+    const char* text = input.Ptr();
+    s64 length = (s64)input.Length();
+    for (s64 line_start = 0; line_start < length;)
+    {
+        const char* newline = (const char*)memchr(text + line_start, '\n', length - line_start);
+        s64 line_end = (newline) ? newline - text : length;
+        IString line = {text + line_start, (MSTRING_SIZE_T)(line_end - line_start)};
 
-        result += (first_digit * 10) + last_digit;
+        s32 first = matchers.forward.FirstMatch(line);
+        if (first != Matcher::NoMatch) result += (first % 10) * 10 + matchers.backward.FirstMatch(line) % 10;
+        line_start = line_end + 1;
     }
     return result;
 }
 
+// Both parts are sums over lines, so they can split the input into chunks of whole lines and sum those on
+// every core. There are a few chunks per worker, so one slow chunk doesn't leave everyone else waiting.
+template <typename F> static s64 SumInParallel(IString input, F part)
+{
+    s64 chunk_size = (s64)input.Length() / (Jobs::WorkerCount() * ChunksPerWorker);
+    if (chunk_size < MinChunkSize) chunk_size = MinChunkSize;
+    TArray<IString> chunks = Jobs::SplitLines(input, chunk_size);
+    return ParallelReduce(Span<IString>(chunks.begin(), chunks.Length()), 1, (s64)0,
+                          [&](Span<IString> group, s64* sum) {for (IString chunk : group) *sum += part(chunk);},
+                          [](s64* result, s64 sum) {*result += sum;});
+}
+
 int main(int argc, char* argv[])
 {
-    // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
-    Span<u8> input_file = Platform::ReadFileToBuffer(path);
+    // Arguments are the input path (optional), and one of:
+    // --parallel    Split the input into chunks of lines, and sum them on every core.
+    // --stream      Like --parallel, but read the file a block at a time (reading the next block while the
+    //               current one is summed), so it never has to be in memory all at once. Both parts are
+    //               summed in the same pass, so they're timed together.
+    IString path = DEFAULT_INPUT_PATH;
+    bool parallel = false;
+    bool stream = false;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        if (arg == "--parallel") parallel = true;
+        else if (arg == "--stream") stream = true;
+        else path = arg;
+    }
+    if (parallel || stream) Jobs::Start();
+
+    // Part two's automata only depend on the digit names, not the input, so they're built before timing starts.
+    DigitMatchers matchers = BuildDigitMatchers();
 
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s32 part1 = DoPartOne({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    auto part_two = [&](IString chunk) {return DoPartTwo(chunk, matchers);};
+    s64 part1 = 0;
+    s64 part2 = 0;
+    if (stream)
+    {
+        LineStream lines = {};
+        if (!lines.Open(path, StreamBlockSize))
+        {
+            PrintF("Couldn't open %.*s\n", (s32)path.Length(), path.Ptr());
+            Jobs::Stop();
+            return 1;
+        }
+        IString block;
+        while (lines.Next(&block))
+        {
+            part1 += SumInParallel(block, DoPartOne);
+            part2 += SumInParallel(block, part_two);
+        }
+        if (lines.failed) PrintLog("Couldn't read the whole input!\n");
+        lines.Close();
 
-    s32 part2 = DoPartTwo({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+        u64 us = Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer));
+        PrintF("Part 1: %lld\nPart 2: %lld\n(Both computed in %lldus)\n", part1, part2, us);
+    }
+    else
+    {
+        // Map the input file. Both parts read from the one copy.
+        Span<const u8> input_file = Platform::MapFile(path);
+        IString input = {(const char*)input_file.ptr, (MSTRING_SIZE_T)input_file.count};
 
-    // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+        part1 = (parallel) ? SumInParallel(input, DoPartOne) : DoPartOne(input);
+        u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+
+        part2 = (parallel) ? SumInParallel(input, part_two) : part_two(input);
+        u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+
+        // Stop timing.
+        u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
+        u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+
+        // Print results.
+        PrintF("Part 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
+        Platform::UnmapFile(input_file);
+    }
 
-    // Print results.
-    PrintF("Part 1: %d (Computed in %lldus)\nPart 2: %d (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
-    // Free the input file and exit.
-    free(input_file.ptr);
+    if (parallel || stream) Jobs::Stop();
     return 0;
 }
@@ -0,0 +1,137 @@
+#include "Core/Lines.h"
+#include "Platform/Platform.h"
+
+namespace LinesInternal
+{
+// Each kernel does as many whole vectors as fit, then finishes the tail a byte at a time.
+struct CountNewlines
+{
+    template <typename Backend> static s64 Run(const char* ptr, s64 length)
+    {
+        using U8 = typename Backend::U8;
+        U8 newline = U8::Splat('\n');
+        s64 result = 0;
+        s64 offset = 0;
+        for (; offset + U8::lanes <= length; offset += U8::lanes)
+        {
+            result += Backend::PopCount(MoveMask(Equal(U8::Load(ptr + offset), newline)));
+        }
+        for (; offset < length; ++offset) result += (ptr[offset] == '\n');
+        return result;
+    }
+};
+
+struct FindNewline
+{
+    template <typename Backend> static s64 Run(const char* ptr, s64 offset, s64 length)
+    {
+        using U8 = typename Backend::U8;
+        U8 newline = U8::Splat('\n');
+        for (; offset + U8::lanes <= length; offset += U8::lanes)
+        {
+            u64 mask = MoveMask(Equal(U8::Load(ptr + offset), newline));
+            if (mask) return offset + Simd::CountTrailingZeros(mask);
+        }
+        while (offset < length && ptr[offset] != '\n') ++offset;
+        return offset;
+    }
+};
+
+// Writes the start of every line after the first, and returns how many were written.
+struct CollectLineStarts
+{
+    template <typename Backend> static s64 Run(const char* ptr, s64 length, u32* out_starts)
+    {
+        using U8 = typename Backend::U8;
+        U8 newline = U8::Splat('\n');
+        s64 written = 0;
+        s64 offset = 0;
+        for (; offset + U8::lanes <= length; offset += U8::lanes)
+        {
+            u64 mask = MoveMask(Equal(U8::Load(ptr + offset), newline));
+            while (mask)
+            {
+                s64 next_start = offset + Simd::CountTrailingZeros(mask) + 1;
+                if (next_start < length) out_starts[written++] = (u32)next_start;
+                mask &= mask - 1;
+            }
+        }
+        for (; offset < length; ++offset)
+        {
+            if (ptr[offset] == '\n' && offset + 1 < length) out_starts[written++] = (u32)(offset + 1);
+        }
+        return written;
+    }
+};
+
+static inline s64 CountNewlinesIn(IString input) {return Simd::Dispatch<CountNewlines>(input.Ptr(), (s64)input.Length());}
+
+static inline bool EndsInNewline(IString input) {return (input.Length() && input[input.Length() - 1] == '\n');}
+} // namespace LinesInternal
+
+s64 FindLineEnd(IString input, s64 offset)
+{
+    return Simd::Dispatch<LinesInternal::FindNewline>(input.Ptr(), offset, (s64)input.Length());
+}
+
+s64 CountLines(IString input)
+{
+    if (input.Length() == 0) return 0;
+    return LinesInternal::CountNewlinesIn(input) + !LinesInternal::EndsInNewline(input);
+}
+
+s64 UniformLineWidth(IString input)
+{
+    s64 length = (s64)input.Length();
+    if (length == 0) return -1;
+    s64 width = FindLineEnd(input, 0);
+    s64 stride = width + 1;
+
+    // If every line is the same width, the length is fixed by the width and the line count, and the newlines
+    // can only be at the end of each stride. Checking those is enough: the newline count comes from the line
+    // count, so if they're all at the ends of strides there can't be any others.
+    s64 line_count = CountLines(input);
+    s64 newline_count = line_count - !LinesInternal::EndsInNewline(input);
+    if (length != line_count * stride - !LinesInternal::EndsInNewline(input)) return -1;
+    for (s64 line = 0; line < newline_count; ++line)
+    {
+        if (input.Ptr()[line * stride + width] != '\n') return -1;
+    }
+    return width;
+}
+
+IString LineIndex::operator[](s64 line) const
+{
+    Assert(line >= 0 && line < Count());
+    s64 start = starts[(tarray_int)line];
+    s64 end = (line + 1 < Count()) ? starts[(tarray_int)line + 1] - 1 : (s64)input.Length() - LinesInternal::EndsInNewline(input);
+    return IString(input.Ptr() + start, (MSTRING_SIZE_T)(end - start));
+}
+
+LineIndex BuildLineIndex(IString input)
+{
+    LineIndex result = {};
+    result.input = input;
+    AssertCustom((s64)input.Length() <= (s64)U32_MAX, "Line offsets are u32, so the input can't be bigger than 4 GiB.");
+    s64 line_count = CountLines(input);
+    if (line_count == 0) return result;
+
+    // Counting first lets us size the array exactly, so the second pass is just stores.
+    result.starts.SetLength((tarray_int)line_count);
+    u32* starts = &result.starts[0];
+    starts[0] = 0;
+    s64 written = 1 + Simd::Dispatch<LinesInternal::CollectLineStarts>(input.Ptr(), (s64)input.Length(), starts + 1);
+
+    Assert(written == line_count);
+    return result;
+}
+
+bool LineIterator::Next(IString* out_line)
+{
+    Assert(out_line);
+    if (offset >= (s64)input.Length()) return false;
+    s64 end = FindLineEnd(input, offset);
+    *out_line = IString(input.Ptr() + offset, (MSTRING_SIZE_T)(end - offset));
+    offset = end + 1;
+    return true;
+}
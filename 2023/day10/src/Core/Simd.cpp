@@ -0,0 +1,36 @@
+#include "Core/Simd.h"
+#include "Platform/Platform.h"
+
+static Simd::Isa QueryBestIsa()
+{
+    const Platform::CpuFeatureFlags& features = Platform::CpuFeatures();
+    (void)features; // Unused if this build has no SIMD backends at all.
+#ifdef SIMD_AVX512
+    if (features.avx512 && features.avx2 && features.popcnt) return Simd::Isa::Avx512;
+#endif
+#ifdef SIMD_AVX2
+    if (features.avx2 && features.popcnt) return Simd::Isa::Avx2;
+#endif
+#ifdef SIMD_SSE42
+    if (features.sse42 && features.popcnt) return Simd::Isa::Sse42;
+#endif
+    return Simd::Isa::Scalar;
+}
+
+Simd::Isa Simd::BestIsa()
+{
+    static Isa isa = QueryBestIsa();
+    return isa;
+}
+
+const char* Simd::IsaName(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Scalar: return "Scalar";
+        case Isa::Sse42: return "SSE4.2";
+        case Isa::Avx2: return "AVX2";
+        case Isa::Avx512: return "AVX-512";
+    }
+    return "Unknown";
+}
@@ -0,0 +1,467 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// ========================================================================== //
+// Thin SIMD vector types, with one backend per instruction set:
+// Simd::Scalar  - u8x16, s32x4,  s64x2 (plain arrays, works anywhere)
+// Simd::Sse42   - u8x16, s32x4,  s64x2 (SSE4.2 + POPCNT)
+// Simd::Avx2    - u8x32, s32x8,  s64x4
+// Simd::Avx512  - u8x64, s32x16, s64x8 (AVX-512 F + BW)
+//
+// Every backend has the same operations, so a kernel is written once as a template on the backend and
+// instantiated for each of them. Dispatch() then picks the best instantiation for the CPU we're
+// actually running on, the first time it's called:
+//
+// struct CountZeros
+// {
+//     template <typename Backend> static s64 Run(const u8* ptr, s64 count)
+//     {
+//         using U8 = typename Backend::U8;
+//         ...
+//     }
+// };
+// s64 zeros = Simd::Dispatch<CountZeros>(ptr, count);
+//
+// Vectors operate lane-wise. Comparisons return all-ones lanes where true and zero lanes where false,
+// and MoveMask() packs the top bit of each byte lane into a u64 (lane 0 in bit 0). Shuffle() behaves
+// like pshufb: indices select bytes within each 16-byte group, and an index with its top bit set gives 0.
+// LoadBytes() on the 32-bit vectors reads one byte per lane and zero extends it, for widening u8 data.
+//
+// MSVC lets any intrinsic be used regardless of /arch, so with MSVC every backend is compiled in and the
+// choice is made entirely at runtime. Other compilers only allow intrinsics the build targets, so there a
+// backend is only compiled in if the matching -m flags are on (e.g. -mavx2).
+// ========================================================================== //
+
+#if defined _M_X64 || defined __x86_64__
+#if defined _MSC_VER || (defined __SSE4_2__ && defined __POPCNT__)
+#define SIMD_SSE42
+#endif
+#if defined _MSC_VER || (defined __AVX2__ && defined __POPCNT__)
+#define SIMD_AVX2
+#endif
+#if defined _MSC_VER || (defined __AVX512F__ && defined __AVX512BW__ && defined __POPCNT__)
+#define SIMD_AVX512
+#endif
+#endif
+
+#if defined SIMD_SSE42 || defined SIMD_AVX2 || defined SIMD_AVX512
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Simd
+{
+enum class Isa : u32
+{
+    Scalar = 0,
+    Sse42,
+    Avx2,
+    Avx512,
+};
+
+// Best instruction set supported by both this CPU and this build. Queried once, then cached.
+Isa BestIsa();
+const char* IsaName(Isa isa);
+
+// Index of the lowest set bit. Undefined for zero, so check first.
+inline s32 CountTrailingZeros(u64 value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (s32)index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// Number of zero bits above the highest set bit. Undefined for zero, so check first.
+inline s32 CountLeadingZeros(u64 value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (s32)index;
+#else
+    return __builtin_clzll(value);
+#endif
+}
+
+// ========================================================================== //
+// Scalar backend.
+// ========================================================================== //
+namespace Scalar
+{
+#define SIMD_SCALAR_LANEWISE(type, op) \
+inline type operator op(type a, type b) {type result; for (s64 i = 0; i < type::lanes; ++i) result.v[i] = (type::Lane)((type::Bits)a.v[i] op (type::Bits)b.v[i]); return result;}
+
+struct u8x16
+{
+    using Lane = u8;
+    using Bits = u32; // Lane arithmetic is done unsigned, so it wraps like the vector instructions do.
+    static constexpr s64 lanes = 16;
+    u8 v[16];
+
+    static u8x16 Load(const void* ptr) {u8x16 result; memcpy(result.v, ptr, sizeof(result.v)); return result;}
+    static u8x16 Splat(u8 value) {u8x16 result; for (u8& lane : result.v) lane = value; return result;}
+    void Store(void* ptr) const {memcpy(ptr, v, sizeof(v));}
+};
+SIMD_SCALAR_LANEWISE(u8x16, +)
+SIMD_SCALAR_LANEWISE(u8x16, -)
+SIMD_SCALAR_LANEWISE(u8x16, &)
+SIMD_SCALAR_LANEWISE(u8x16, |)
+SIMD_SCALAR_LANEWISE(u8x16, ^)
+inline u8x16 Equal(u8x16 a, u8x16 b) {u8x16 result; for (s64 i = 0; i < 16; ++i) result.v[i] = (a.v[i] == b.v[i]) ? 0xff : 0; return result;}
+inline u8x16 Min(u8x16 a, u8x16 b) {u8x16 result; for (s64 i = 0; i < 16; ++i) result.v[i] = (a.v[i] < b.v[i]) ? a.v[i] : b.v[i]; return result;}
+inline u8x16 Max(u8x16 a, u8x16 b) {u8x16 result; for (s64 i = 0; i < 16; ++i) result.v[i] = (a.v[i] > b.v[i]) ? a.v[i] : b.v[i]; return result;}
+inline u8x16 Shuffle(u8x16 table, u8x16 indices)
+{
+    u8x16 result;
+    for (s64 i = 0; i < 16; ++i) result.v[i] = (indices.v[i] & 0x80) ? 0 : table.v[indices.v[i] & 15];
+    return result;
+}
+inline u64 MoveMask(u8x16 a) {u64 result = 0; for (s64 i = 0; i < 16; ++i) result |= (u64)(a.v[i] >> 7) << i; return result;}
+
+struct s32x4
+{
+    using Lane = s32;
+    using Bits = u32;
+    static constexpr s64 lanes = 4;
+    s32 v[4];
+
+    static s32x4 Load(const void* ptr) {s32x4 result; memcpy(result.v, ptr, sizeof(result.v)); return result;}
+    static s32x4 LoadBytes(const void* ptr) {s32x4 result; for (s64 i = 0; i < 4; ++i) result.v[i] = ((const u8*)ptr)[i]; return result;}
+    static s32x4 Splat(s32 value) {s32x4 result; for (s32& lane : result.v) lane = value; return result;}
+    void Store(void* ptr) const {memcpy(ptr, v, sizeof(v));}
+};
+SIMD_SCALAR_LANEWISE(s32x4, +)
+SIMD_SCALAR_LANEWISE(s32x4, -)
+SIMD_SCALAR_LANEWISE(s32x4, *)
+SIMD_SCALAR_LANEWISE(s32x4, &)
+SIMD_SCALAR_LANEWISE(s32x4, |)
+SIMD_SCALAR_LANEWISE(s32x4, ^)
+inline s32x4 Equal(s32x4 a, s32x4 b) {s32x4 result; for (s64 i = 0; i < 4; ++i) result.v[i] = -(s32)(a.v[i] == b.v[i]); return result;}
+inline s32x4 Greater(s32x4 a, s32x4 b) {s32x4 result; for (s64 i = 0; i < 4; ++i) result.v[i] = -(s32)(a.v[i] > b.v[i]); return result;}
+inline s32x4 Min(s32x4 a, s32x4 b) {s32x4 result; for (s64 i = 0; i < 4; ++i) result.v[i] = (a.v[i] < b.v[i]) ? a.v[i] : b.v[i]; return result;}
+inline s32x4 Max(s32x4 a, s32x4 b) {s32x4 result; for (s64 i = 0; i < 4; ++i) result.v[i] = (a.v[i] > b.v[i]) ? a.v[i] : b.v[i]; return result;}
+inline s32 Sum(s32x4 a) {return (s32)((u32)a.v[0] + (u32)a.v[1] + (u32)a.v[2] + (u32)a.v[3]);}
+
+struct s64x2
+{
+    using Lane = s64;
+    using Bits = u64;
+    static constexpr s64 lanes = 2;
+    s64 v[2];
+
+    static s64x2 Load(const void* ptr) {s64x2 result; memcpy(result.v, ptr, sizeof(result.v)); return result;}
+    static s64x2 Splat(s64 value) {return {{value, value}};}
+    void Store(void* ptr) const {memcpy(ptr, v, sizeof(v));}
+};
+SIMD_SCALAR_LANEWISE(s64x2, +)
+SIMD_SCALAR_LANEWISE(s64x2, -)
+SIMD_SCALAR_LANEWISE(s64x2, &)
+SIMD_SCALAR_LANEWISE(s64x2, |)
+SIMD_SCALAR_LANEWISE(s64x2, ^)
+inline s64x2 Equal(s64x2 a, s64x2 b) {return {{-(s64)(a.v[0] == b.v[0]), -(s64)(a.v[1] == b.v[1])}};}
+inline s64x2 Greater(s64x2 a, s64x2 b) {return {{-(s64)(a.v[0] > b.v[0]), -(s64)(a.v[1] > b.v[1])}};}
+inline s64 Sum(s64x2 a) {return (s64)((u64)a.v[0] + (u64)a.v[1]);}
+
+#undef SIMD_SCALAR_LANEWISE
+
+struct Backend
+{
+    static constexpr Isa isa = Isa::Scalar;
+    using U8 = u8x16;
+    using S32 = s32x4;
+    using S64 = s64x2;
+
+    static s32 PopCount(u64 value)
+    {
+        value = value - ((value >> 1) & 0x5555555555555555ull);
+        value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+        return (s32)((((value + (value >> 4)) & 0x0f0f0f0f0f0f0f0full) * 0x0101010101010101ull) >> 56);
+    }
+};
+} // namespace Scalar
+
+// ========================================================================== //
+// SSE4.2 backend.
+// ========================================================================== //
+#ifdef SIMD_SSE42
+namespace Sse42
+{
+struct u8x16
+{
+    static constexpr s64 lanes = 16;
+    __m128i v;
+
+    static u8x16 Load(const void* ptr) {return {_mm_loadu_si128((const __m128i*)ptr)};}
+    static u8x16 Splat(u8 value) {return {_mm_set1_epi8((char)value)};}
+    void Store(void* ptr) const {_mm_storeu_si128((__m128i*)ptr, v);}
+};
+inline u8x16 operator+(u8x16 a, u8x16 b) {return {_mm_add_epi8(a.v, b.v)};}
+inline u8x16 operator-(u8x16 a, u8x16 b) {return {_mm_sub_epi8(a.v, b.v)};}
+inline u8x16 operator&(u8x16 a, u8x16 b) {return {_mm_and_si128(a.v, b.v)};}
+inline u8x16 operator|(u8x16 a, u8x16 b) {return {_mm_or_si128(a.v, b.v)};}
+inline u8x16 operator^(u8x16 a, u8x16 b) {return {_mm_xor_si128(a.v, b.v)};}
+inline u8x16 Equal(u8x16 a, u8x16 b) {return {_mm_cmpeq_epi8(a.v, b.v)};}
+inline u8x16 Min(u8x16 a, u8x16 b) {return {_mm_min_epu8(a.v, b.v)};}
+inline u8x16 Max(u8x16 a, u8x16 b) {return {_mm_max_epu8(a.v, b.v)};}
+inline u8x16 Shuffle(u8x16 table, u8x16 indices) {return {_mm_shuffle_epi8(table.v, indices.v)};}
+inline u64 MoveMask(u8x16 a) {return (u32)_mm_movemask_epi8(a.v);}
+
+struct s32x4
+{
+    static constexpr s64 lanes = 4;
+    __m128i v;
+
+    static s32x4 Load(const void* ptr) {return {_mm_loadu_si128((const __m128i*)ptr)};}
+    static s32x4 LoadBytes(const void* ptr) {s32 bytes; memcpy(&bytes, ptr, sizeof(bytes)); return {_mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes))};}
+    static s32x4 Splat(s32 value) {return {_mm_set1_epi32(value)};}
+    void Store(void* ptr) const {_mm_storeu_si128((__m128i*)ptr, v);}
+};
+inline s32x4 operator+(s32x4 a, s32x4 b) {return {_mm_add_epi32(a.v, b.v)};}
+inline s32x4 operator-(s32x4 a, s32x4 b) {return {_mm_sub_epi32(a.v, b.v)};}
+inline s32x4 operator*(s32x4 a, s32x4 b) {return {_mm_mullo_epi32(a.v, b.v)};}
+inline s32x4 operator&(s32x4 a, s32x4 b) {return {_mm_and_si128(a.v, b.v)};}
+inline s32x4 operator|(s32x4 a, s32x4 b) {return {_mm_or_si128(a.v, b.v)};}
+inline s32x4 operator^(s32x4 a, s32x4 b) {return {_mm_xor_si128(a.v, b.v)};}
+inline s32x4 Equal(s32x4 a, s32x4 b) {return {_mm_cmpeq_epi32(a.v, b.v)};}
+inline s32x4 Greater(s32x4 a, s32x4 b) {return {_mm_cmpgt_epi32(a.v, b.v)};}
+inline s32x4 Min(s32x4 a, s32x4 b) {return {_mm_min_epi32(a.v, b.v)};}
+inline s32x4 Max(s32x4 a, s32x4 b) {return {_mm_max_epi32(a.v, b.v)};}
+inline s32 Sum(s32x4 a)
+{
+    __m128i sum = _mm_add_epi32(a.v, _mm_shuffle_epi32(a.v, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+struct s64x2
+{
+    static constexpr s64 lanes = 2;
+    __m128i v;
+
+    static s64x2 Load(const void* ptr) {return {_mm_loadu_si128((const __m128i*)ptr)};}
+    static s64x2 Splat(s64 value) {return {_mm_set1_epi64x(value)};}
+    void Store(void* ptr) const {_mm_storeu_si128((__m128i*)ptr, v);}
+};
+inline s64x2 operator+(s64x2 a, s64x2 b) {return {_mm_add_epi64(a.v, b.v)};}
+inline s64x2 operator-(s64x2 a, s64x2 b) {return {_mm_sub_epi64(a.v, b.v)};}
+inline s64x2 operator&(s64x2 a, s64x2 b) {return {_mm_and_si128(a.v, b.v)};}
+inline s64x2 operator|(s64x2 a, s64x2 b) {return {_mm_or_si128(a.v, b.v)};}
+inline s64x2 operator^(s64x2 a, s64x2 b) {return {_mm_xor_si128(a.v, b.v)};}
+inline s64x2 Equal(s64x2 a, s64x2 b) {return {_mm_cmpeq_epi64(a.v, b.v)};}
+inline s64x2 Greater(s64x2 a, s64x2 b) {return {_mm_cmpgt_epi64(a.v, b.v)};}
+inline s64 Sum(s64x2 a) {return _mm_cvtsi128_si64(_mm_add_epi64(a.v, _mm_unpackhi_epi64(a.v, a.v)));}
+
+struct Backend
+{
+    static constexpr Isa isa = Isa::Sse42;
+    using U8 = u8x16;
+    using S32 = s32x4;
+    using S64 = s64x2;
+
+    static s32 PopCount(u64 value) {return (s32)_mm_popcnt_u64(value);}
+};
+} // namespace Sse42
+#endif // SIMD_SSE42
+
+// ========================================================================== //
+// AVX2 backend. Shuffle() works within each 16-byte half, same as vpshufb.
+// ========================================================================== //
+#ifdef SIMD_AVX2
+namespace Avx2
+{
+struct u8x32
+{
+    static constexpr s64 lanes = 32;
+    __m256i v;
+
+    static u8x32 Load(const void* ptr) {return {_mm256_loadu_si256((const __m256i*)ptr)};}
+    static u8x32 Splat(u8 value) {return {_mm256_set1_epi8((char)value)};}
+    void Store(void* ptr) const {_mm256_storeu_si256((__m256i*)ptr, v);}
+};
+inline u8x32 operator+(u8x32 a, u8x32 b) {return {_mm256_add_epi8(a.v, b.v)};}
+inline u8x32 operator-(u8x32 a, u8x32 b) {return {_mm256_sub_epi8(a.v, b.v)};}
+inline u8x32 operator&(u8x32 a, u8x32 b) {return {_mm256_and_si256(a.v, b.v)};}
+inline u8x32 operator|(u8x32 a, u8x32 b) {return {_mm256_or_si256(a.v, b.v)};}
+inline u8x32 operator^(u8x32 a, u8x32 b) {return {_mm256_xor_si256(a.v, b.v)};}
+inline u8x32 Equal(u8x32 a, u8x32 b) {return {_mm256_cmpeq_epi8(a.v, b.v)};}
+inline u8x32 Min(u8x32 a, u8x32 b) {return {_mm256_min_epu8(a.v, b.v)};}
+inline u8x32 Max(u8x32 a, u8x32 b) {return {_mm256_max_epu8(a.v, b.v)};}
+inline u8x32 Shuffle(u8x32 table, u8x32 indices) {return {_mm256_shuffle_epi8(table.v, indices.v)};}
+inline u64 MoveMask(u8x32 a) {return (u32)_mm256_movemask_epi8(a.v);}
+
+struct s32x8
+{
+    static constexpr s64 lanes = 8;
+    __m256i v;
+
+    static s32x8 Load(const void* ptr) {return {_mm256_loadu_si256((const __m256i*)ptr)};}
+    static s32x8 LoadBytes(const void* ptr) {return {_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)ptr))};}
+    static s32x8 Splat(s32 value) {return {_mm256_set1_epi32(value)};}
+    void Store(void* ptr) const {_mm256_storeu_si256((__m256i*)ptr, v);}
+};
+inline s32x8 operator+(s32x8 a, s32x8 b) {return {_mm256_add_epi32(a.v, b.v)};}
+inline s32x8 operator-(s32x8 a, s32x8 b) {return {_mm256_sub_epi32(a.v, b.v)};}
+inline s32x8 operator*(s32x8 a, s32x8 b) {return {_mm256_mullo_epi32(a.v, b.v)};}
+inline s32x8 operator&(s32x8 a, s32x8 b) {return {_mm256_and_si256(a.v, b.v)};}
+inline s32x8 operator|(s32x8 a, s32x8 b) {return {_mm256_or_si256(a.v, b.v)};}
+inline s32x8 operator^(s32x8 a, s32x8 b) {return {_mm256_xor_si256(a.v, b.v)};}
+inline s32x8 Equal(s32x8 a, s32x8 b) {return {_mm256_cmpeq_epi32(a.v, b.v)};}
+inline s32x8 Greater(s32x8 a, s32x8 b) {return {_mm256_cmpgt_epi32(a.v, b.v)};}
+inline s32x8 Min(s32x8 a, s32x8 b) {return {_mm256_min_epi32(a.v, b.v)};}
+inline s32x8 Max(s32x8 a, s32x8 b) {return {_mm256_max_epi32(a.v, b.v)};}
+inline s32 Sum(s32x8 a)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(a.v), _mm256_extracti128_si256(a.v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+struct s64x4
+{
+    static constexpr s64 lanes = 4;
+    __m256i v;
+
+    static s64x4 Load(const void* ptr) {return {_mm256_loadu_si256((const __m256i*)ptr)};}
+    static s64x4 Splat(s64 value) {return {_mm256_set1_epi64x(value)};}
+    void Store(void* ptr) const {_mm256_storeu_si256((__m256i*)ptr, v);}
+};
+inline s64x4 operator+(s64x4 a, s64x4 b) {return {_mm256_add_epi64(a.v, b.v)};}
+inline s64x4 operator-(s64x4 a, s64x4 b) {return {_mm256_sub_epi64(a.v, b.v)};}
+inline s64x4 operator&(s64x4 a, s64x4 b) {return {_mm256_and_si256(a.v, b.v)};}
+inline s64x4 operator|(s64x4 a, s64x4 b) {return {_mm256_or_si256(a.v, b.v)};}
+inline s64x4 operator^(s64x4 a, s64x4 b) {return {_mm256_xor_si256(a.v, b.v)};}
+inline s64x4 Equal(s64x4 a, s64x4 b) {return {_mm256_cmpeq_epi64(a.v, b.v)};}
+inline s64x4 Greater(s64x4 a, s64x4 b) {return {_mm256_cmpgt_epi64(a.v, b.v)};}
+inline s64 Sum(s64x4 a)
+{
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(a.v), _mm256_extracti128_si256(a.v, 1));
+    return _mm_cvtsi128_si64(_mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum)));
+}
+
+struct Backend
+{
+    static constexpr Isa isa = Isa::Avx2;
+    using U8 = u8x32;
+    using S32 = s32x8;
+    using S64 = s64x4;
+
+    static s32 PopCount(u64 value) {return (s32)_mm_popcnt_u64(value);}
+};
+} // namespace Avx2
+#endif // SIMD_AVX2
+
+// ========================================================================== //
+// AVX-512 backend. Comparisons produce mask registers natively, and are expanded back into vectors
+// here so that every backend looks the same. Shuffle() works within each 16-byte quarter.
+// ========================================================================== //
+#ifdef SIMD_AVX512
+namespace Avx512
+{
+struct u8x64
+{
+    static constexpr s64 lanes = 64;
+    __m512i v;
+
+    static u8x64 Load(const void* ptr) {return {_mm512_loadu_si512(ptr)};}
+    static u8x64 Splat(u8 value) {return {_mm512_set1_epi8((char)value)};}
+    void Store(void* ptr) const {_mm512_storeu_si512(ptr, v);}
+};
+inline u8x64 operator+(u8x64 a, u8x64 b) {return {_mm512_add_epi8(a.v, b.v)};}
+inline u8x64 operator-(u8x64 a, u8x64 b) {return {_mm512_sub_epi8(a.v, b.v)};}
+inline u8x64 operator&(u8x64 a, u8x64 b) {return {_mm512_and_si512(a.v, b.v)};}
+inline u8x64 operator|(u8x64 a, u8x64 b) {return {_mm512_or_si512(a.v, b.v)};}
+inline u8x64 operator^(u8x64 a, u8x64 b) {return {_mm512_xor_si512(a.v, b.v)};}
+inline u8x64 Equal(u8x64 a, u8x64 b) {return {_mm512_movm_epi8(_mm512_cmpeq_epi8_mask(a.v, b.v))};}
+inline u8x64 Min(u8x64 a, u8x64 b) {return {_mm512_min_epu8(a.v, b.v)};}
+inline u8x64 Max(u8x64 a, u8x64 b) {return {_mm512_max_epu8(a.v, b.v)};}
+inline u8x64 Shuffle(u8x64 table, u8x64 indices) {return {_mm512_shuffle_epi8(table.v, indices.v)};}
+inline u64 MoveMask(u8x64 a) {return (u64)_mm512_movepi8_mask(a.v);}
+
+struct s32x16
+{
+    static constexpr s64 lanes = 16;
+    __m512i v;
+
+    static s32x16 Load(const void* ptr) {return {_mm512_loadu_si512(ptr)};}
+    static s32x16 LoadBytes(const void* ptr) {return {_mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)ptr))};}
+    static s32x16 Splat(s32 value) {return {_mm512_set1_epi32(value)};}
+    void Store(void* ptr) const {_mm512_storeu_si512(ptr, v);}
+};
+inline s32x16 operator+(s32x16 a, s32x16 b) {return {_mm512_add_epi32(a.v, b.v)};}
+inline s32x16 operator-(s32x16 a, s32x16 b) {return {_mm512_sub_epi32(a.v, b.v)};}
+inline s32x16 operator*(s32x16 a, s32x16 b) {return {_mm512_mullo_epi32(a.v, b.v)};}
+inline s32x16 operator&(s32x16 a, s32x16 b) {return {_mm512_and_si512(a.v, b.v)};}
+inline s32x16 operator|(s32x16 a, s32x16 b) {return {_mm512_or_si512(a.v, b.v)};}
+inline s32x16 operator^(s32x16 a, s32x16 b) {return {_mm512_xor_si512(a.v, b.v)};}
+inline s32x16 Equal(s32x16 a, s32x16 b) {return {_mm512_maskz_mov_epi32(_mm512_cmpeq_epi32_mask(a.v, b.v), _mm512_set1_epi32(-1))};}
+inline s32x16 Greater(s32x16 a, s32x16 b) {return {_mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(a.v, b.v), _mm512_set1_epi32(-1))};}
+inline s32x16 Min(s32x16 a, s32x16 b) {return {_mm512_min_epi32(a.v, b.v)};}
+inline s32x16 Max(s32x16 a, s32x16 b) {return {_mm512_max_epi32(a.v, b.v)};}
+inline s32 Sum(s32x16 a) {return _mm512_reduce_add_epi32(a.v);}
+
+struct s64x8
+{
+    static constexpr s64 lanes = 8;
+    __m512i v;
+
+    static s64x8 Load(const void* ptr) {return {_mm512_loadu_si512(ptr)};}
+    static s64x8 Splat(s64 value) {return {_mm512_set1_epi64(value)};}
+    void Store(void* ptr) const {_mm512_storeu_si512(ptr, v);}
+};
+inline s64x8 operator+(s64x8 a, s64x8 b) {return {_mm512_add_epi64(a.v, b.v)};}
+inline s64x8 operator-(s64x8 a, s64x8 b) {return {_mm512_sub_epi64(a.v, b.v)};}
+inline s64x8 operator&(s64x8 a, s64x8 b) {return {_mm512_and_si512(a.v, b.v)};}
+inline s64x8 operator|(s64x8 a, s64x8 b) {return {_mm512_or_si512(a.v, b.v)};}
+inline s64x8 operator^(s64x8 a, s64x8 b) {return {_mm512_xor_si512(a.v, b.v)};}
+inline s64x8 Equal(s64x8 a, s64x8 b) {return {_mm512_maskz_mov_epi64(_mm512_cmpeq_epi64_mask(a.v, b.v), _mm512_set1_epi64(-1))};}
+inline s64x8 Greater(s64x8 a, s64x8 b) {return {_mm512_maskz_mov_epi64(_mm512_cmpgt_epi64_mask(a.v, b.v), _mm512_set1_epi64(-1))};}
+inline s64 Sum(s64x8 a) {return _mm512_reduce_add_epi64(a.v);}
+
+struct Backend
+{
+    static constexpr Isa isa = Isa::Avx512;
+    using U8 = u8x64;
+    using S32 = s32x16;
+    using S64 = s64x8;
+
+    static s32 PopCount(u64 value) {return (s32)_mm_popcnt_u64(value);}
+};
+} // namespace Avx512
+#endif // SIMD_AVX512
+
+// ========================================================================== //
+// Dispatch.
+// ========================================================================== //
+
+// Instantiation of Kernel::Run for the given instruction set, falling back to the next best one
+// that this build has.
+template <typename Kernel> inline auto SelectKernel(Isa isa) -> decltype(&Kernel::template Run<Scalar::Backend>)
+{
+#ifdef SIMD_AVX512
+    if (isa >= Isa::Avx512) return &Kernel::template Run<Avx512::Backend>;
+#endif
+#ifdef SIMD_AVX2
+    if (isa >= Isa::Avx2) return &Kernel::template Run<Avx2::Backend>;
+#endif
+#ifdef SIMD_SSE42
+    if (isa >= Isa::Sse42) return &Kernel::template Run<Sse42::Backend>;
+#endif
+    return &Kernel::template Run<Scalar::Backend>;
+}
+
+// Calls the best instantiation of Kernel::Run for this CPU. The choice is made once per kernel and cached,
+// so after the first call this costs one indirect call.
+template <typename Kernel, typename... Args> inline auto Dispatch(Args... args)
+{
+    static const auto function = SelectKernel<Kernel>(BestIsa());
+    return function(args...);
+}
+} // namespace Simd
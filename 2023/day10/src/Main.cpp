@@ -121,13 +121,13 @@ void PrintMap(Map& map)
 
 Map ParseInput(Span<char> input)
 {
-    s32 cols = 0;
-    while (input[cols] != '\n') ++cols;
-    s32 rows = (s32)input.count / (cols + 1);
-    if (input[input.count - 1] != '\n') rows += 1; // Include the last row even if it doesn't have a line feed at the end.
+    IString text = {input.ptr, (u32)input.count};
+    s32 cols = (s32)UniformLineWidth(text);
+    s32 rows = (s32)CountLines(text);
+    AssertCustom(cols > 0, "Expected every line to be the same width.");
 
     Map map = {(u8*)malloc(rows * cols), cols, rows};
-    for (s32 y = 0; y < rows; ++y) for (s32 x = 0; x < cols; ++x) map(x, y) = TranslateSymbol(input[(rows + 1) * y + x]);
+    for (s32 y = 0; y < rows; ++y) for (s32 x = 0; x < cols; ++x) map(x, y) = TranslateSymbol(input[(cols + 1) * y + x]);
     for (s32 y = 0; y < rows; ++y) for (s32 x = 0; x < cols; ++x) FixConnections(map, x, y);
     return map;
 }
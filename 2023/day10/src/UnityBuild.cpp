@@ -2,5 +2,7 @@
 #include "Core/EngineCore.h"
 
 #include "Core/EngineCore.cpp"
+#include "Core/Simd.cpp"
+#include "Core/Lines.cpp"
 #include "Platform/Platform.cpp"
 #include "Main.cpp"
\ No newline at end of file
@@ -13,39 +13,56 @@ s32 DistanceBetween(Galaxy a, Galaxy b)
     return ABS(a.x - b.x) + ABS(a.y - b.y);
 }
 
-static s64 DoPartOne(Span<char> input)
+// Galaxy positions as they appear in the input, and the indices of the empty rows and columns (in
+// increasing order). The parts only differ in how much they grow the empty space.
+struct ParsedInput
 {
-    s32 cols = 0;
-    while (input[cols] != '\n') ++cols;
-    s32 rows = (s32)input.count / (cols + 1);
-    if (input[input.count - 1] != '\n') ++rows; // If the last line isn't null terminated, we will have rounded incorrectly, so add one to the row count.
+    TArray<Galaxy> galaxies;
+    TArray<s32> empty_cols;
+    TArray<s32> empty_rows;
+};
 
-    // Create a list of row and column indices which are empty.
-    TArray<s32> empty_cols = {};
-    TArray<s32> empty_rows = {};
+static ParsedInput Parse(Span<const char> input)
+{
+    IString text = {input.ptr, (u32)input.count};
+    s32 cols = (s32)UniformLineWidth(text);
+    s32 rows = (s32)CountLines(text);
+    AssertCustom(cols > 0, "Expected every line to be the same width.");
+
+    ParsedInput result = {};
+
+    // View the input as a grid. Each line ends in a newline, so rows are cols + 1 apart.
+    Span2D<const char> grid = {input.ptr, cols, rows, cols + 1};
 
     // Scan each column, appending its index to the array if we find that it is empty.
     for (s32 col = 0; col < cols; ++col)
     {
         bool is_empty = true;
-        for (s32 row = 0; row < rows; ++row) if (input[row * (cols + 1) + col] != '.') {is_empty = false; break;}
-        if (is_empty) empty_cols.Append(col);
+        for (char c : grid.Column(col)) if (c != '.') {is_empty = false; break;}
+        if (is_empty) result.empty_cols.Append(col);
     }
 
     // Do the same, but for empty rows.
     for (s32 row = 0; row < rows; ++row)
     {
         bool is_empty = true;
-        for (s32 col = 0; col < cols; ++col) if (input[row * (cols + 1) + col] != '.') {is_empty = false; break;}
-        if (is_empty) empty_rows.Append(row);
+        for (char c : grid.Row(row)) if (c != '.') {is_empty = false; break;}
+        if (is_empty) result.empty_rows.Append(row);
     }
 
     // Scan for galaxies. We could have done all three of these scans in one pass, if we cared about parsing speed.
-    TArray<Galaxy> galaxies = {};
     for (s32 row = 0; row < rows; ++row)
     {
-        for (s32 col = 0; col < cols; ++col) if (input[row * (cols + 1) + col] == '#') galaxies.Append({col, row});
+        for (s32 col = 0; col < cols; ++col) if (grid(col, row) == '#') result.galaxies.Append({col, row});
     }
+    return result;
+}
+
+static s64 DoPartOne(const ParsedInput& input)
+{
+    TArray<Galaxy> galaxies = input.galaxies;
+    const TArray<s32>& empty_cols = input.empty_cols;
+    const TArray<s32>& empty_rows = input.empty_rows;
 
     for (Galaxy& g : galaxies)
     {
@@ -67,39 +84,11 @@ static s64 DoPartOne(Span<char> input)
     return total_length;
 }
 
-static s64 DoPartTwo(Span<char> input)
+static s64 DoPartTwo(const ParsedInput& input)
 {
-    s32 cols = 0;
-    while (input[cols] != '\n') ++cols;
-    s32 rows = (s32)input.count / (cols + 1);
-    if (input[input.count - 1] != '\n') ++rows; // If the last line isn't null terminated, we will have rounded incorrectly, so add one to the row count.
-
-    // Create a list of row and column indices which are empty.
-    TArray<s32> empty_cols = {};
-    TArray<s32> empty_rows = {};
-
-    // Scan each column, appending its index to the array if we find that it is empty.
-    for (s32 col = 0; col < cols; ++col)
-    {
-        bool is_empty = true;
-        for (s32 row = 0; row < rows; ++row) if (input[row * (cols + 1) + col] != '.') {is_empty = false; break;}
-        if (is_empty) empty_cols.Append(col);
-    }
-
-    // Do the same, but for empty rows.
-    for (s32 row = 0; row < rows; ++row)
-    {
-        bool is_empty = true;
-        for (s32 col = 0; col < cols; ++col) if (input[row * (cols + 1) + col] != '.') {is_empty = false; break;}
-        if (is_empty) empty_rows.Append(row);
-    }
-
-    // Scan for galaxies. We could have done all three of these scans in one pass, if we cared about parsing speed.
-    TArray<Galaxy> galaxies = {};
-    for (s32 row = 0; row < rows; ++row)
-    {
-        for (s32 col = 0; col < cols; ++col) if (input[row * (cols + 1) + col] == '#') galaxies.Append({col, row});
-    }
+    TArray<Galaxy> galaxies = input.galaxies;
+    const TArray<s32>& empty_cols = input.empty_cols;
+    const TArray<s32>& empty_rows = input.empty_rows;
 
     for (Galaxy& g : galaxies)
     {
@@ -122,32 +111,74 @@ static s64 DoPartTwo(Span<char> input)
     return total_length;
 }
 
+typedef s64 PartFunction(const ParsedInput& input);
+
+struct PartRun
+{
+    PartFunction* function;
+    const ParsedInput* input;
+    s64 result;
+    u64 us;
+};
+
+// Runs and times one part. Takes a void* so that it can also be a thread's entry point.
+static void RunPart(void* data)
+{
+    PartRun* run = (PartRun*)data;
+    Platform::Timer timer = {};
+    Platform::TimerStart(&timer);
+    run->result = run->function(*run->input);
+    run->us = Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer));
+}
+
 int main(int argc, char* argv[])
 {
+    // Arguments are the input path (optional), and --concurrent to run the two parts at the same time.
+    IString path = DEFAULT_INPUT_PATH;
+    bool concurrent = false;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        if (arg == "--concurrent") concurrent = true;
+        else path = arg;
+    }
+
     // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
     Span<u8> input_file = Platform::ReadFileToBuffer(path);
 
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s64 part1 = DoPartOne({(char*)input_file.ptr, input_file.count});
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    // Parse once, for both parts.
+    ParsedInput parsed = Parse({(const char*)input_file.ptr, input_file.count});
+    u64 parse_counts = Platform::TimerMeasureCounts(&timer);
 
-    s64 part2 = DoPartTwo({(char*)input_file.ptr, input_file.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+    // Do the actual work. Concurrently, part two gets a thread of its own while part one runs on this one.
+    PartRun part1 = {DoPartOne, &parsed};
+    PartRun part2 = {DoPartTwo, &parsed};
+    if (concurrent)
+    {
+        Platform::Thread thread = Platform::StartThread(RunPart, &part2);
+        AssertCustom(thread.handle, "Failed to start a thread for part two.");
+        RunPart(&part1);
+        Platform::JoinThread(&thread);
+    }
+    else
+    {
+        RunPart(&part1);
+        RunPart(&part2);
+    }
+    u64 total_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+    u64 parse_us = Platform::TimerCountsToMicroseconds(&timer, parse_counts);
+    u64 total_us = Platform::TimerCountsToMicroseconds(&timer, total_counts);
 
     // Print results.
-    PrintF("Part 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
+    PrintF("Parsed in %lldus\nPart 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\nTotal: %lldus%s\n",
+           parse_us, part1.result, part1.us, part2.result, part2.us, total_us, concurrent ? " (parts ran concurrently)" : "");
     // Free the input file and exit.
     free(input_file.ptr);
     return 0;
 }
-
-
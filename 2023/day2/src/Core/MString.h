@@ -40,8 +40,9 @@ struct IString
     constexpr MSTRING_SIZE_T Length() const {return length;}
     constexpr const char* Ptr() const {return ptr;}
 
-    // Array access.
-    constexpr const char& operator[](MSTRING_SIZE_T i) const {return Ptr()[i];}
+    // Array access. Templated on the index type so that any integer is an exact match, otherwise indexing
+    // with anything but MSTRING_SIZE_T is ambiguous with the built-in operator via operator const char*().
+    template <typename Index> constexpr const char& operator[](Index i) const {return Ptr()[i];}
 
     // "Legacy iterator" stuff.
     constexpr const char* begin() const {return Ptr();}
@@ -95,8 +96,8 @@ struct MString
     constexpr operator const char*() const {return Ptr();}
     constexpr operator char*() {return Ptr();}
 
-    constexpr const char& operator[](MSTRING_SIZE_T i) const {return Ptr()[i];}
-    constexpr char& operator[](MSTRING_SIZE_T i) {return Ptr()[i];}
+    template <typename Index> constexpr const char& operator[](Index i) const {return Ptr()[i];}
+    template <typename Index> constexpr char& operator[](Index i) {return Ptr()[i];}
 
     // "Legacy iterator" stuff.
     constexpr char* begin() {return Ptr();}
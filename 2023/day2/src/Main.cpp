@@ -1,4 +1,3 @@
-
 #include "Core/EngineCore.h"
 #include "Platform/Platform.h"
 
@@ -8,168 +7,443 @@
 #define MAX_GREEN 13
 #define MAX_BLUE 14
 
-// Parses a number out of the input starting at offset, updating the offset to the end of the parsed number.
-// Doesn't parse negative numbers.
-static s32 ParseNumber(IString input, s32* offset)
+constexpr s64 CheckedQueries = 1000; // How many of the --queries answers get checked against a scan.
+constexpr s32 MaxQueryCubes = 31; // Random query limits go from 0 to this.
+
+// The most cubes of each color shown in any hand of a game is all either part needs to know. Those are kept
+// in one column per color, a byte per game, so the parts can compare and multiply 16 to 64 games at a time.
+// Game IDs start at 1 and count up, so the ID of game i is i + 1, and doesn't need a column of its own.
+enum Color
 {
-    s32 result = 0;
-    while (*offset < input.Length() && input[*offset] >= '0' && input[*offset] <= '9')
-    {
-        s32 digit = input[*offset] - '0';
-        result = result * 10 + digit;
-        *offset += 1;
-    }
+    Red,
+    Green,
+    Blue,
+    ColorCount,
+};
 
-    return result;
-}
+// Columns are padded with zero games up to a multiple of the widest vector, so the parts never need a scalar tail.
+constexpr s64 MaxLanes = 64;
 
+struct ParsedInput
+{
+    s64 game_count;
+    TArray<u8> max_cubes[ColorCount]; // max_cubes[color][game].
+};
 
-static s32 DoPartOne(IString input)
+/**
+ * Tokenizes the games 64 bytes at a time. Everything that depends on the bytes themselves is worked out for
+ * the whole block with vector ops, and written to a couple of small per-block tables:
+ *
+ * - Masks of digits, newlines and colons. A number ending just before a colon is a game ID, and every other
+ *   number is a count, so the counts and the newlines are the only events.
+ * - The value of the 1-2 digit number ending at each byte. Each lane looks one byte back (the loads are just
+ *   offset by one), so the tens are added in without any shuffling, and lanes that aren't digits are zeroed.
+ * - The color of the count ending at each byte, from the initial two bytes after it. 'g' and 'b' are enough
+ *   to tell the colors apart, since the initial after a count is always r, g or b.
+ *
+ * The counts are then folded into the game being read in order, with no data-dependent branches: its maxima
+ * are packed into one register, 16 bits per color, and updated by masking rather than selecting. Every event
+ * writes them into the game's row. A newline counts as zero (so it never changes a maximum), then moves on to
+ * the next row and clears them. Nothing is checked per event. The one thing the tables can't represent, a
+ * count of three digits or more, is collected per block and checked once at the end.
+ */
+struct TokenizeGames
 {
-    s32 result = 0;
-    s32 last_id = 0;
+    // Lets a block look two bytes back and two bytes ahead of itself.
+    constexpr static s64 Margin = 2;
 
-    // Iterate through lines.
-    for (s32 file_offset = 0; file_offset < input.Length(); ++file_offset)
+    struct State
     {
-        // We will check this at the end of the line to see if this game was possible.
-        bool was_game_possible = true;
+        u8* columns[ColorCount];
+        s64 row;
+        u64 game; // The maxima so far, 16 bits per color.
+        u64 long_counts; // Nonzero if any count had more than two digits.
+    };
 
-        // Parse ID. We end on the index of the colon.
-        s32 id = last_id + 1;
-        ++last_id;
-        while (input[file_offset] != ':') ++file_offset;
+    template <typename Backend> static void ScanBlock(const char* block, State* state)
+    {
+        using U8 = typename Backend::U8;
+        U8 zero = U8::Splat('0');
+        U8 nine = U8::Splat(9);
+        U8 newline = U8::Splat('\n');
+        U8 colon = U8::Splat(':');
+        U8 green_initial = U8::Splat('g');
+        U8 blue_initial = U8::Splat('b');
+        U8 green_shift = U8::Splat(Green * 16);
+        U8 blue_shift = U8::Splat(Blue * 16);
 
-        // Iterate through hands in a line.
-        while (file_offset < input.Length() && input[file_offset] != '\n')
+        alignas(64) u8 counts[64];
+        alignas(64) u8 shifts[64];
+        u64 digits = 0;
+        u64 newlines = 0;
+        u64 colons = 0;
+        u64 three_digits = 0;
+        for (s64 i = 0; i < 64; i += U8::lanes)
         {
-            Assert(input[file_offset] == ';' || input[file_offset] == ':');
+            // Digits become 0-9, and everything else wraps to something bigger.
+            U8 bytes = U8::Load(block + i);
+            U8 ones = bytes - zero;
+            U8 tens = U8::Load(block + i - 1) - zero;
+            U8 hundreds = U8::Load(block + i - 2) - zero;
+            U8 is_digit = Equal(Min(ones, nine), ones);
+            U8 has_tens = Equal(Min(tens, nine), tens);
+            U8 has_hundreds = Equal(Min(hundreds, nine), hundreds);
+
+            // tens * 10 as (tens * 8) + (tens * 2), since there's no byte multiply. 99 still fits in a byte.
+            U8 tens_2 = tens & has_tens;
+            tens_2 = tens_2 + tens_2;
+            U8 tens_8 = tens_2 + tens_2;
+            tens_8 = tens_8 + tens_8;
+            ((ones + tens_8 + tens_2) & is_digit).Store(counts + i);
+
+            U8 initial = U8::Load(block + i + 2);
+            ((Equal(initial, green_initial) & green_shift) | (Equal(initial, blue_initial) & blue_shift)).Store(shifts + i);
 
-            // Iterate through colors in a hand.
-            do
+            digits |= MoveMask(is_digit) << i;
+            newlines |= MoveMask(Equal(bytes, newline)) << i;
+            colons |= MoveMask(Equal(bytes, colon)) << i;
+            three_digits |= MoveMask(is_digit & has_tens & has_hundreds) << i;
+        }
+        u64 next_digit = (u64)((u8)(block[64] - '0') < 10) << 63;
+        u64 next_colon = (u64)(block[64] == ':') << 63;
+        u64 number_ends = digits & ~((digits >> 1) | next_digit);
+        u64 count_ends = number_ends & ~((colons >> 1) | next_colon);
+        state->long_counts |= count_ends & three_digits;
+
+        // Locals, since byte stores could alias anything behind the state pointer.
+        u64 game = state->game;
+        s64 row = state->row;
+        u8* red = state->columns[Red];
+        u8* green = state->columns[Green];
+        u8* blue = state->columns[Blue];
+        for (u64 events = count_ends | newlines; events; events &= events - 1)
+        {
+            s64 end = Simd::CountTrailingZeros(events);
+            u64 count = counts[end]; // Zero for a newline.
+            u64 shift = shifts[end];
+            u64 cubes = (game >> shift) & 0xffff;
+            u64 greater = 0 - (u64)(count > cubes); // A mask rather than a select, so the compiler can't turn it into a branch.
+            game ^= ((cubes ^ count) & greater) << shift;
+
+            red[row] = (u8)game;
+            green[row] = (u8)(game >> 16);
+            blue[row] = (u8)(game >> 32);
+            u64 is_newline = (newlines >> end) & 1;
+            row += is_newline;
+            game &= is_newline - 1; // All ones, unless this was a newline.
+        }
+        state->game = game;
+        state->row = row;
+    }
+
+    template <typename Backend> static void Run(const char* ptr, s64 length, ParsedInput* out)
+    {
+        // A block has at most 64 newlines, so keep room for 64 more rows before each one. The rows are
+        // only written up to the one being parsed, so anything after it is still zero, which is the padding.
+        State state = {};
+        auto reserve = [&](s64 rows)
+        {
+            for (TArray<u8>& column : out->max_cubes)
             {
-                file_offset += 2; // Skip to the start of the next number.
-                s32 number = ParseNumber(input, &file_offset);
-                file_offset += 1; // Skip the space to get to the start of the color.
-
-                switch (input[file_offset])
-                {
-                    case 'r':
-                    {
-                        file_offset += 3;
-                        if (number > MAX_RED) was_game_possible = false;
-                        break;
-                    }
-                    case 'g':
-                    {
-                        file_offset += 5;
-                        if (number > MAX_GREEN) was_game_possible = false;
-                        break;
-                    }
-                    case 'b':
-                    {
-                        file_offset += 4;
-                        if (number > MAX_BLUE) was_game_possible = false;
-                        break;
-                    }
-                    default: Assert(false);
-                }
-            } while (file_offset < input.Length() && input[file_offset] == ',');
+                if (column.Length() < rows) column.SetLength((tarray_int)((rows > column.Length() * 2) ? rows : column.Length() * 2));
+            }
+            for (s32 color = 0; color < ColorCount; ++color) state.columns[color] = out->max_cubes[color];
+        };
+
+        for (s64 offset = 0; offset < length; offset += 64)
+        {
+            reserve(state.row + 65);
+            if (offset >= Margin && offset + 64 + Margin <= length) ScanBlock<Backend>(ptr + offset, &state);
+            else
+            {
+                // The first and last blocks are copied out, with zeros (neither digits nor newlines) past either end of the input.
+                char padded[Margin + 64 + Margin] = {};
+                s64 first = (offset >= Margin) ? offset - Margin : 0;
+                s64 last = (offset + 64 + Margin <= length) ? offset + 64 + Margin : length;
+                memcpy(padded + Margin - (offset - first), ptr + first, last - first);
+                ScanBlock<Backend>(padded + Margin, &state);
+            }
         }
-        ++file_offset;
 
-        if (was_game_possible) result += id;
+        AssertCustom(!state.long_counts, "Expected every count to be one or two digits.");
+
+        // The last line doesn't need a newline.
+        if (length && ptr[length - 1] != '\n') state.row += 1;
+        out->game_count = state.row;
+        s64 padded_count = (state.row + MaxLanes - 1) / MaxLanes * MaxLanes;
+        for (TArray<u8>& column : out->max_cubes) column.SetLength((tarray_int)padded_count);
     }
+};
+
+static ParsedInput Parse(Span<const char> input_text)
+{
+    ParsedInput result = {};
+    Simd::Dispatch<TokenizeGames>(input_text.ptr, input_text.count, &result);
     return result;
 }
 
-static s32 DoPartTwo(IString input)
+// How many cubes of each color were in the bag. A game was possible if it never showed more than that.
+struct CubeLimits
 {
-    s32 result = 0;
-    s32 last_id = 0;
+    s32 cubes[ColorCount];
+};
 
-    // Iterate through lines.
-    for (s32 file_offset = 0; file_offset < input.Length(); ++file_offset)
+// A game was possible if no color went over its limit, that is if Min(max, limit) == max for all of them.
+struct SumPossibleIds
+{
+    template <typename Backend> static s64 Run(const ParsedInput* input, CubeLimits bag)
     {
-        // We will check this at the end of the line to see if this game was possible.
-        s32 min_red = 0;
-        s32 min_green = 0;
-        s32 min_blue = 0;
-
-        // Parse ID. We end on the index of the colon.
-        s32 id = last_id + 1;
-        ++last_id;
-        while (input[file_offset] != ':') ++file_offset;
-
-        // Iterate through hands in a line.
-        while (file_offset < input.Length() && input[file_offset] != '\n')
+        using U8 = typename Backend::U8;
+        U8 limits[ColorCount];
+        for (s32 color = 0; color < ColorCount; ++color)
         {
-            Assert(input[file_offset] == ';' || input[file_offset] == ':');
+            // No game ever shows more than a byte's worth, so bigger limits are the same as U8_MAX.
+            if (bag.cubes[color] < 0) return 0;
+            limits[color] = U8::Splat((u8)((bag.cubes[color] < U8_MAX) ? bag.cubes[color] : U8_MAX));
+        }
 
-            // Iterate through colors in a hand.
-            do
+        s64 result = 0;
+        for (s64 first = 0; first < input->game_count; first += U8::lanes)
+        {
+            U8 possible = U8::Splat(0xff);
+            for (s32 color = 0; color < ColorCount; ++color)
             {
-                file_offset += 2; // Skip to the start of the next number.
-                s32 number = ParseNumber(input, &file_offset);
-                file_offset += 1; // Skip the space to get to the start of the color.
-
-                switch (input[file_offset])
-                {
-                    case 'r':
-                    {
-                        file_offset += 3;
-                        if (number > min_red) min_red = number;
-                        break;
-                    }
-                    case 'g':
-                    {
-                        file_offset += 5;
-                        if (number > min_green) min_green = number;
-                        break;
-                    }
-                    case 'b':
-                    {
-                        file_offset += 4;
-                        if (number > min_blue) min_blue = number;
-                        break;
-                    }
-                    default: Assert(false);
-                }
-            } while (file_offset < input.Length() && input[file_offset] == ',');
+                U8 cubes = U8::Load(&input->max_cubes[color][(tarray_int)first]);
+                possible = possible & Equal(Min(cubes, limits[color]), cubes);
+            }
+
+            // The padding games have no cubes at all, so they'd look possible.
+            u64 games = MoveMask(possible);
+            if (input->game_count - first < U8::lanes) games &= (1ull << (input->game_count - first)) - 1;
+
+            // Lane i holds the game with ID first + i + 1.
+            result += Backend::PopCount(games) * (first + 1);
+            for (; games; games &= games - 1) result += Simd::CountTrailingZeros(games);
+        }
+        return result;
+    }
+};
+
+// Widens each color to 32 bits and multiplies them. 255^3 fits easily, and so does the sum of a vector of them.
+struct SumPowers
+{
+    template <typename Backend> static s64 Run(const ParsedInput* input)
+    {
+        using S32 = typename Backend::S32;
+        const u8* red = input->max_cubes[Red];
+        const u8* green = input->max_cubes[Green];
+        const u8* blue = input->max_cubes[Blue];
+
+        s64 result = 0;
+        for (s64 first = 0; first < input->game_count; first += S32::lanes)
+        {
+            S32 power = S32::LoadBytes(red + first) * S32::LoadBytes(green + first) * S32::LoadBytes(blue + first);
+            result += Sum(power); // The padding games multiply out to zero.
         }
-        ++file_offset;
+        return result;
+    }
+};
+
+static s64 DoPartOne(const ParsedInput& input)
+{
+    return Simd::Dispatch<SumPossibleIds>(&input, CubeLimits{MAX_RED, MAX_GREEN, MAX_BLUE});
+}
+
+static s64 DoPartTwo(const ParsedInput& input)
+{
+    return Simd::Dispatch<SumPowers>(&input);
+}
+
+/**
+ * Answers "what's the sum of the IDs of the games that were possible with these limits?" in O(1), for when
+ * there are a lot of different bags to ask about. A game is possible when its maxima are all <= the limits,
+ * so the answer is a sum over a box in (red, green, blue) space, which a 3D prefix sum gives in one lookup.
+ *
+ * Each axis only needs one cell per distinct maximum of that color (plus one for "less than all of them"),
+ * and ranks[color][cubes] maps a limit straight to its cell. There are at most 256 distinct maxima per
+ * color, but real inputs have a couple dozen, so the table is tiny.
+ */
+struct GameIndex
+{
+    u16 ranks[ColorCount][U8_MAX + 1]; // How many distinct maxima of the color are <= cubes.
+    s64 sizes[ColorCount]; // Cells along each axis.
+    TArray<s64> id_sums; // id_sums[(red * sizes[Green] + green) * sizes[Blue] + blue], for cells (not cubes).
 
-        result += (min_red * min_green * min_blue);
+    s64 Query(CubeLimits bag) const
+    {
+        s64 cells[ColorCount];
+        for (s32 color = 0; color < ColorCount; ++color)
+        {
+            s32 cubes = bag.cubes[color];
+            if (cubes < 0) return 0;
+            cells[color] = ranks[color][(cubes < U8_MAX) ? cubes : U8_MAX];
+        }
+        return id_sums[(tarray_int)((cells[Red] * sizes[Green] + cells[Green]) * sizes[Blue] + cells[Blue])];
+    }
+
+    void QueryBatch(Span<const CubeLimits> bags, Span<s64> out_sums) const
+    {
+        Assert(out_sums.count >= bags.count);
+        for (s64 i = 0; i < bags.count; ++i) out_sums[i] = Query(bags[i]);
+    }
+};
+
+static GameIndex BuildGameIndex(const ParsedInput& input)
+{
+    GameIndex result = {};
+
+    // Rank the distinct maxima of each color. A game with maximum m goes in cell ranks[m], which is at least 1.
+    for (s32 color = 0; color < ColorCount; ++color)
+    {
+        bool seen[U8_MAX + 1] = {};
+        for (s64 game = 0; game < input.game_count; ++game) seen[input.max_cubes[color][(tarray_int)game]] = true;
+        u16 rank = 0;
+        for (s32 cubes = 0; cubes <= U8_MAX; ++cubes)
+        {
+            rank += seen[cubes];
+            result.ranks[color][cubes] = rank;
+        }
+        result.sizes[color] = rank + 1;
+    }
+
+    s64 stride_red = result.sizes[Green] * result.sizes[Blue];
+    s64 stride_green = result.sizes[Blue];
+    result.id_sums = TArray<s64>((tarray_int)(result.sizes[Red] * stride_red));
+    s64* sums = result.id_sums;
+    for (s64 game = 0; game < input.game_count; ++game)
+    {
+        s64 red = result.ranks[Red][input.max_cubes[Red][(tarray_int)game]];
+        s64 green = result.ranks[Green][input.max_cubes[Green][(tarray_int)game]];
+        s64 blue = result.ranks[Blue][input.max_cubes[Blue][(tarray_int)game]];
+        sums[red * stride_red + green * stride_green + blue] += game + 1;
+    }
+
+    // Prefix sum along each axis in turn, after which every cell holds the sum over the box below it.
+    for (s64 red = 0; red < result.sizes[Red]; ++red)
+    {
+        for (s64 green = 0; green < result.sizes[Green]; ++green)
+        {
+            s64* row = sums + red * stride_red + green * stride_green;
+            for (s64 blue = 1; blue < result.sizes[Blue]; ++blue) row[blue] += row[blue - 1];
+            if (green) for (s64 blue = 0; blue < result.sizes[Blue]; ++blue) row[blue] += row[blue - stride_green];
+        }
+        if (red) for (s64 cell = 0; cell < stride_red; ++cell) sums[red * stride_red + cell] += sums[(red - 1) * stride_red + cell];
     }
     return result;
 }
 
+// Builds a GameIndex, answers query_count random bags with it in one batch, and checks some of the answers
+// against a scan. Queries come from a fixed seed, so runs can be compared.
+static void RunQueryBenchmark(const ParsedInput& input, s64 query_count)
+{
+    Platform::Timer timer = {};
+    Platform::TimerStart(&timer);
+    GameIndex index = BuildGameIndex(input);
+    u64 build_counts = Platform::TimerMeasureCounts(&timer);
+
+    TArray<CubeLimits> bags = TArray<CubeLimits>((tarray_int)query_count);
+    TArray<s64> sums = TArray<s64>((tarray_int)query_count);
+    u64 random = 0x9e3779b97f4a7c15ull;
+    for (CubeLimits& bag : bags)
+    {
+        // xorshift64, which is plenty for picking limits.
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        for (s32 color = 0; color < ColorCount; ++color) bag.cubes[color] = (s32)((random >> (color * 16)) % (MaxQueryCubes + 1));
+    }
+
+    u64 start_counts = Platform::TimerMeasureCounts(&timer);
+    index.QueryBatch({bags.begin(), bags.Length()}, {sums.begin(), sums.Length()});
+    u64 query_counts = Platform::TimerMeasureCounts(&timer) - start_counts;
+
+    s64 checked = (query_count < CheckedQueries) ? query_count : CheckedQueries;
+    s64 wrong = 0;
+    for (s64 i = 0; i < checked; ++i)
+    {
+        if (sums[(tarray_int)i] != Simd::Dispatch<SumPossibleIds>(&input, bags[(tarray_int)i])) wrong += 1;
+    }
+
+    u64 build_us = Platform::TimerCountsToMicroseconds(&timer, build_counts);
+    u64 query_us = Platform::TimerCountsToMicroseconds(&timer, query_counts);
+    PrintF("Index built in %lldus (%lld x %lld x %lld cells)\n%lld queries answered in %lldus (%.2fns each)\n",
+           build_us, index.sizes[Red], index.sizes[Green], index.sizes[Blue], query_count, query_us, (double)query_us * 1000.0 / (double)query_count);
+    PrintF("Checked %lld of them against a scan: %s\n", checked, (wrong) ? "WRONG ANSWERS" : "all correct");
+}
+
+typedef s64 PartFunction(const ParsedInput& input);
+
+struct PartRun
+{
+    PartFunction* function;
+    const ParsedInput* input;
+    s64 result;
+    u64 us;
+};
+
+// Runs and times one part. Takes a void* so that it can also be a thread's entry point.
+static void RunPart(void* data)
+{
+    PartRun* run = (PartRun*)data;
+    Platform::Timer timer = {};
+    Platform::TimerStart(&timer);
+    run->result = run->function(*run->input);
+    run->us = Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer));
+}
+
 int main(int argc, char* argv[])
 {
+    // Arguments are the input path (optional), and any of:
+    // --concurrent    Run the two parts at the same time.
+    // --queries N     Afterwards, answer N random bags with a GameIndex, and time that (see RunQueryBenchmark).
+    IString path = DEFAULT_INPUT_PATH;
+    bool concurrent = false;
+    s64 query_count = 0;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        if (arg == "--concurrent") concurrent = true;
+        else if (arg == "--queries" && i + 1 < argc) query_count = atoll(argv[++i]);
+        else path = arg;
+    }
+
     // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
     Span<u8> input_file = Platform::ReadFileToBuffer(path);
 
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s32 part1 = DoPartOne({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    // Parse once, for both parts.
+    ParsedInput parsed = Parse({(const char*)input_file.ptr, input_file.count});
+    u64 parse_counts = Platform::TimerMeasureCounts(&timer);
 
-    s32 part2 = DoPartTwo({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+    // Do the actual work. Concurrently, part two gets a thread of its own while part one runs on this one.
+    PartRun part1 = {DoPartOne, &parsed};
+    PartRun part2 = {DoPartTwo, &parsed};
+    if (concurrent)
+    {
+        Platform::Thread thread = Platform::StartThread(RunPart, &part2);
+        AssertCustom(thread.handle, "Failed to start a thread for part two.");
+        RunPart(&part1);
+        Platform::JoinThread(&thread);
+    }
+    else
+    {
+        RunPart(&part1);
+        RunPart(&part2);
+    }
+    u64 total_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+    u64 parse_us = Platform::TimerCountsToMicroseconds(&timer, parse_counts);
+    u64 total_us = Platform::TimerCountsToMicroseconds(&timer, total_counts);
 
     // Print results.
-    PrintF("Part 1: %d (Computed in %lldus)\nPart 2: %d (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
+    PrintF("Parsed in %lldus\nPart 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\nTotal: %lldus%s\n",
+           parse_us, part1.result, part1.us, part2.result, part2.us, total_us, concurrent ? " (parts ran concurrently)" : "");
+    if (query_count > 0) RunQueryBenchmark(parsed, query_count);
     // Free the input file and exit.
     free(input_file.ptr);
     return 0;
 }
-
-
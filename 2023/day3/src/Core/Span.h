@@ -17,8 +17,8 @@
  * A basic begin() and end() implementation are provided so that range-based for loops work in the same way
  * as for static arrays.
  *
- * Note that NO bounds checking or null checking is performed, to keep this wrapper as thin as possible.
- * Use at your own risk.
+ * Indexing and slicing are bounds checked with Assert, so the checks disappear entirely in NDEBUG builds and
+ * this stays as thin as a raw pointer in release. No null checking is performed.
  */
 template <typename T> struct Span
 {
@@ -29,13 +29,111 @@ template <typename T> struct Span
     constexpr Span(T* first, s64 count) : ptr(first), count(count) {}
     template<s64 N> constexpr Span(T(&arr)[N]) : ptr(arr), count(N) {} // Initialize from a static array.
 
-    constexpr Span<T> First(s64 n)              { return {ptr, n}; }             // First N elements.
-    constexpr Span<T> Last(s64 n)               { return {&ptr[count - n], n}; } // Last N elements.
-    constexpr Span<T> SubSpan(s64 first, s64 n) { return {ptr + offset, n}; }    // N elements starting at first.
-    constexpr s64 ByteSize() {return count * sizeof(T);}
+    // First N elements.
+    constexpr Span<T> First(s64 n) const
+    {
+        Assert(n >= 0 && n <= count);
+        return {ptr, n};
+    }
 
-    constexpr T& operator[](s64 i) const { return ptr[i]; };
+    // Last N elements.
+    constexpr Span<T> Last(s64 n) const
+    {
+        Assert(n >= 0 && n <= count);
+        return {ptr + (count - n), n};
+    }
+
+    // N elements starting at first.
+    constexpr Span<T> SubSpan(s64 first, s64 n) const
+    {
+        Assert(first >= 0 && n >= 0 && first + n <= count);
+        return {ptr + first, n};
+    }
+
+    constexpr s64 ByteSize() const {return count * sizeof(T);}
+
+    constexpr T& operator[](s64 i) const
+    {
+        Assert(i >= 0 && i < count);
+        return ptr[i];
+    }
 
     constexpr T* begin() const { return ptr; }
     constexpr T* end() const { return ptr + count; }
-};
\ No newline at end of file
+};
+
+/**
+ * A span whose elements are stride elements apart instead of adjacent, like one column of a grid.
+ * Same rules as Span: no ownership, and bounds checks only in debug builds.
+ */
+template <typename T> struct StridedSpan
+{
+    T* ptr;
+    s64 count;
+    s64 stride; // Distance between consecutive elements, in elements (not bytes).
+
+    constexpr StridedSpan() = default;
+    constexpr StridedSpan(T* first, s64 count, s64 stride) : ptr(first), count(count), stride(stride) {}
+
+    constexpr T& operator[](s64 i) const
+    {
+        Assert(i >= 0 && i < count);
+        return ptr[i * stride];
+    }
+
+    // Just enough of an iterator for range-based for loops.
+    struct Iterator
+    {
+        T* ptr;
+        s64 stride;
+
+        constexpr T& operator*() const {return *ptr;}
+        constexpr Iterator& operator++() {ptr += stride; return *this;}
+        constexpr bool operator!=(const Iterator& other) const {return ptr != other.ptr;}
+    };
+
+    constexpr Iterator begin() const { return {ptr, stride}; }
+    constexpr Iterator end() const { return {ptr + count * stride, stride}; }
+};
+
+/**
+ * A 2D view over rows of width elements, where each row starts stride elements after the previous one.
+ * The stride lets a view skip over padding, such as the newline at the end of each line of a text grid
+ * (in that case, stride is width + 1). Rows come out as plain Spans and columns as StridedSpans, and
+ * SubRegion() gives a smaller view of the same memory, so none of these ever copy.
+ */
+template <typename T> struct Span2D
+{
+    T* ptr;
+    s64 width;
+    s64 height;
+    s64 stride; // Distance between the starts of consecutive rows, in elements.
+
+    constexpr Span2D() = default;
+    constexpr Span2D(T* first, s64 width, s64 height, s64 stride) : ptr(first), width(width), height(height), stride(stride) {}
+
+    constexpr T& operator()(s64 x, s64 y) const
+    {
+        Assert(x >= 0 && x < width && y >= 0 && y < height);
+        return ptr[y * stride + x];
+    }
+
+    constexpr Span<T> Row(s64 y) const
+    {
+        Assert(y >= 0 && y < height);
+        return {ptr + y * stride, width};
+    }
+
+    constexpr StridedSpan<T> Column(s64 x) const
+    {
+        Assert(x >= 0 && x < width);
+        return {ptr + x, height, stride};
+    }
+
+    // A w by h window whose top left corner is at (x, y).
+    constexpr Span2D<T> SubRegion(s64 x, s64 y, s64 w, s64 h) const
+    {
+        Assert(x >= 0 && y >= 0 && w >= 0 && h >= 0 && x + w <= width && y + h <= height);
+        return {ptr + y * stride + x, w, h, stride};
+    }
+};
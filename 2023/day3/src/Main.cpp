@@ -1,197 +1,392 @@
 
 #include "Core/EngineCore.h"
 #include "Platform/Platform.h"
+#include "Core/Jobs.h"
 
 #define DEFAULT_INPUT_PATH "input.txt"
 
-#define MIN(a, b) ((a) < (b) ? (a) : (b))
-#define MAX(a, b) ((a) > (b) ? (a) : (b))
+constexpr s64 StreamBlockSize = 16 << 20;
 
-// Parses a number out of the input starting at offset, updating the offset to the end of the parsed number.
-// Doesn't parse negative numbers.
-static s32 ParseNumber(char* input, s32* offset)
+/**
+ * One bit per cell of the schematic, for digits and for symbols (anything but a digit or a '.'). Each row
+ * gets words_per_row words, and column x is bit x % 64 of word x / 64. Whole rows can then be worked on
+ * 64 columns at a time, however wide the schematic is.
+ */
+struct RowMasks
 {
-    s32 result = 0;
-    while (input[*offset] >= '0' && input[*offset] <= '9')
-    {
-        s32 digit = input[*offset] - '0';
-        result = result * 10 + digit;
-        *offset += 1;
-    }
-
-    return result;
-}
+    s64 words_per_row;
+    TArray<u64> digits;
+    TArray<u64> symbols;
+};
 
-bool IsDigit(char c) {return ((c >= '0' && c <= '9'));}
-bool IsSymbol(char c) {return ((c < '0' || c > '9') && c != '.');}
-
-static char* PadBuffer(IString input, s32 original_line_length, s32 original_line_count, s32* out_line_stride, s32* out_offset)
+struct BuildRowMasks
 {
-    s32 line_length = original_line_length + 2;
-    s32 out_line_count = original_line_count + 2;
+    template <typename Backend> static void Run(const char* input, s64 length, s64 width, s64 height, RowMasks* out)
+    {
+        using U8 = typename Backend::U8;
+        U8 zero = U8::Splat('0');
+        U8 nine = U8::Splat(9);
+        U8 dot = U8::Splat('.');
 
-    *out_line_stride = line_length + 1;
-    *out_offset = (*out_line_stride) + 1;
+        s64 words = out->words_per_row;
+        for (s64 y = 0; y < height; ++y)
+        {
+            for (s64 word = 0; word < words; ++word)
+            {
+                // Only the last few words of the input can run off the end of it. Those get copied out first.
+                const char* chunk = input + y * (width + 1) + word * 64;
+                char padded[64] = {};
+                if (chunk + 64 > input + length)
+                {
+                    memcpy(padded, chunk, input + length - chunk);
+                    chunk = padded;
+                }
 
-    s32 out_size = (line_length + 1) * (original_line_count + 2);
-    char* buf = (char*)malloc(out_size);
+                u64 digits = 0;
+                u64 dots = 0;
+                for (s64 i = 0; i < 64; i += U8::lanes)
+                {
+                    U8 bytes = U8::Load(chunk + i);
+                    U8 value = bytes - zero; // Digits become 0-9, and everything else wraps to something bigger.
+                    digits |= MoveMask(Equal(Min(value, nine), value)) << i;
+                    dots |= MoveMask(Equal(bytes, dot)) << i;
+                }
 
-    for (s32 i = 0; i < line_length; ++i) buf[i] = '.';
-    buf[line_length] = '\n';
-    for (s32 line = 1; line < (out_line_count - 1); ++line)
+                // The last word of a row also picked up the newline and the start of the next row.
+                s64 columns = width - word * 64;
+                u64 in_row = (columns >= 64) ? ~0ull : (1ull << columns) - 1;
+                out->digits[(tarray_int)(y * words + word)] = digits & in_row;
+                out->symbols[(tarray_int)(y * words + word)] = ~(digits | dots) & in_row;
+            }
+        }
+    }
+};
+
+/**
+ * The digits of every number next to a symbol, whole numbers only. Those are the only numbers a symbol can
+ * see, so they're the only ones worth labelling. All of it is shifts, adds and masks on whole words:
+ *
+ * - Each symbol is spread one cell left and right (carrying bits across words), and the spread rows above
+ *   and below are ORed in. ANDed with the digits, that gives the digits touching a symbol, the seeds.
+ * - Seeds grow right to the end of their number by adding them to the digits. The carry out of each seed
+ *   runs through the rest of its run of digits, and on into the next word if the number does.
+ * - They grow left to the start of it with a parallel prefix over the runs, doubling the reach each step,
+ *   word by word from the right so a number can continue down from the word after it.
+ */
+static TArray<u64> SelectPartDigits(const RowMasks& masks, s64 height)
+{
+    s64 words = masks.words_per_row;
+    TArray<u64> spread = TArray<u64>((tarray_int)(height * words));
+    for (s64 y = 0; y < height; ++y)
     {
-        char* offset = buf + ((*out_line_stride) * line);
-        const char* original_offset = input.Ptr() + (original_line_length + 1) * (line - 1);
-        offset[0] = '.';
-        offset[line_length - 1] = '.';
-        offset[line_length] = '\n';
-        memcpy(&offset[1], original_offset, original_line_length);
+        const u64* symbols = &masks.symbols[(tarray_int)(y * words)];
+        for (s64 word = 0; word < words; ++word)
+        {
+            u64 before = (word > 0) ? symbols[word - 1] : 0;
+            u64 after = (word + 1 < words) ? symbols[word + 1] : 0;
+            u64 bits = symbols[word];
+            spread[(tarray_int)(y * words + word)] = bits | (bits << 1) | (before >> 63) | (bits >> 1) | (after << 63);
+        }
     }
 
-    for (s32 i = *out_line_stride * (out_line_count - 1); i < out_size; ++i) buf[i] = '.';
-    buf[out_size - 1] = '\0';
+    TArray<u64> result = TArray<u64>((tarray_int)(height * words));
+    for (s64 y = 0; y < height; ++y)
+    {
+        const u64* digit_row = &masks.digits[(tarray_int)(y * words)];
+        u64* row = &result[(tarray_int)(y * words)];
 
-    return buf;
+        u64 carry = 0;
+        for (s64 word = 0; word < words; ++word)
+        {
+            s64 i = y * words + word;
+            u64 near = spread[(tarray_int)i];
+            if (y > 0) near |= spread[(tarray_int)(i - words)];
+            if (y + 1 < height) near |= spread[(tarray_int)(i + words)];
+
+            u64 digits = digit_row[word];
+            u64 seeds = near & digits;
+            u64 sum = digits + seeds;
+            u64 total = sum + carry;
+            u64 carries_in = total ^ digits ^ seeds; // The carry into each bit, including the one from the last word.
+            carry = (sum < digits) | (total < sum);
+            row[word] = (carries_in | seeds) & digits;
+        }
+
+        u64 from_after = 0; // Whether the first column of the next word was selected.
+        for (s64 word = words - 1; word >= 0; --word)
+        {
+            u64 digits = digit_row[word];
+            u64 selected = row[word] | ((from_after << 63) & digits);
+            u64 run = digits; // Bit i: digits all the way from i up to i + the current reach.
+            for (s32 reach = 1; reach < 64; reach *= 2)
+            {
+                selected |= (selected >> reach) & run;
+                run &= run >> reach;
+            }
+            row[word] = selected;
+            from_after = selected & 1;
+        }
+    }
+    return result;
 }
 
-static s32 DoPartOne(IString input)
+/**
+ * The schematic with every number labelled once. Each run of digits gets an ID, its cells hold that ID in
+ * the label grid, and values[ID] is the number. The grid has a border of empty cells (ID 0) all the way
+ * around, so looking at a symbol's neighbours never needs a bounds check. Numbers that no symbol touches
+ * are left out, since nothing ever looks them up.
+ */
+struct Schematic
 {
-    s32 line_length = 0;
-    while (input[line_length] != '\n') ++line_length;
-    s32 line_count = ((s32)input.Length() / (line_length + 1)) + 1; // Add one, since the last line doesn't have a newline.
+    s64 stride; // Width of the label grid, including the border.
+    TArray<s32> labels;
+    TArray<s64> values; // values[0] is for empty cells, and is always 0.
+    TArray<s64> symbols; // Label grid cell of every symbol, in reading order.
+};
 
-    s32 line_stride = 0;
-    s32 start_offset = 0;
-    char* buf = PadBuffer(input, line_length, line_count, &line_stride, &start_offset);
-
-
-    s32 result = 0;
-    // Iterate through all lines.
-    for (s32 line_idx = 0; line_idx < line_count; ++line_idx)
+static Schematic LabelNumbers(IString input)
+{
+    s64 width = UniformLineWidth(input);
+    s64 height = CountLines(input);
+    AssertCustom(width > 0, "Expected every line to be the same width.");
+
+    RowMasks masks = {};
+    masks.words_per_row = (width + 63) / 64;
+    masks.digits = TArray<u64>((tarray_int)(height * masks.words_per_row));
+    masks.symbols = TArray<u64>((tarray_int)(height * masks.words_per_row));
+    Simd::Dispatch<BuildRowMasks>(input.Ptr(), (s64)input.Length(), width, height, &masks);
+    TArray<u64> part_digits = SelectPartDigits(masks, height);
+
+    Schematic result = {};
+    result.stride = width + 2;
+    result.labels = TArray<s32>((tarray_int)(result.stride * (height + 2)));
+    result.values.Append(0);
+
+    s64 words = masks.words_per_row;
+    for (s64 y = 0; y < height; ++y)
     {
-        char* line = buf + start_offset + (line_stride *  line_idx);
+        const char* line = input.Ptr() + y * (width + 1);
+        s64 row_cell = (y + 1) * result.stride + 1;
+        s32* labels = &result.labels[(tarray_int)row_cell];
 
-        // Iterate through characters, looking for symbols.
-        for (s32 i = 0; i < line_length; ++i)
+        s32 id = 0;
+        s64 last_x = -2;
+        for (s64 word = 0; word < words; ++word)
         {
-            if (IsSymbol(line[i]))
+            for (u64 bits = part_digits[(tarray_int)(y * words + word)]; bits; bits &= bits - 1)
             {
-                // Scan for nearby numbers.
-                for (s32 y = -1; y <= 1; ++y)
-                {
-                    for (s32 x = -1; x <= 1; ++x)
-                    {
-                        s32 j = i + x + (line_stride * y);
-
-                        if (IsDigit(line[j]))
-                        {
-                            // Scan left to find the start of the number.
-                            s32 start_idx = j;
-                            while (IsDigit(line[start_idx])) --start_idx;
-                            ++start_idx;
-
-                            s32 number = ParseNumber(line, &start_idx);
-                            result += number;
-                            // Scan right to skip the remainder of the number.
-                            while (IsDigit(line[j]))
-                            {
-                                ++j;
-                                ++x;
-                            }
-                        }
-                    }
-                }
+                s64 x = word * 64 + Simd::CountTrailingZeros(bits);
+                if (x != last_x + 1) id = (s32)result.values.Append(0) - 1; // Not the next digit of the last number.
+                result.values[id] = result.values[id] * 10 + (line[x] - '0');
+                labels[x] = id;
+                last_x = x;
+            }
+            for (u64 bits = masks.symbols[(tarray_int)(y * words + word)]; bits; bits &= bits - 1)
+            {
+                result.symbols.Append(row_cell + word * 64 + Simd::CountTrailingZeros(bits));
             }
         }
     }
-
-    free(buf);
     return result;
 }
 
-static s32 DoPartTwo(IString input)
+struct SweepResult
+{
+    s64 part_number_sum;
+    s64 gear_ratio_sum;
+};
+
+// One pass over the symbols answers both parts. Each symbol adds up its distinct neighbouring numbers (so a
+// number next to two symbols counts for both), and any symbol with exactly two of them is a gear.
+//
+// A symbol's neighbours are just eight label lookups, and the only way to see the same number twice is for
+// it to cover neighbouring cells in the row above or below (numbers are runs, so the cells either side of
+// the symbol can't be the same one). So comparing each cell with the one before it in its row is all the
+// dedup it takes.
+static SweepResult SweepSymbols(const Schematic& schematic)
 {
-    s32 line_length = 0;
-    while (input[line_length] != '\n') ++line_length;
-    s32 line_count = ((s32)input.Length() / (line_length + 1)) + 1; // Add one, since the last line doesn't have a newline.
+    SweepResult result = {};
+    const s32* labels = schematic.labels;
+    for (s64 cell : schematic.symbols)
+    {
+        s32 neighbours[8];
+        s32 count = 0;
+        for (s64 dy = -1; dy <= 1; ++dy)
+        {
+            const s32* row = labels + cell + dy * schematic.stride;
+            s32 previous = 0;
+            for (s64 dx = -1; dx <= 1; ++dx)
+            {
+                s32 id = row[dx];
+                if (id && id != previous) neighbours[count++] = id;
+                previous = id;
+            }
+        }
 
-    s32 line_stride = 0;
-    s32 start_offset = 0;
-    char* buf = PadBuffer(input, line_length, line_count, &line_stride, &start_offset);
+        for (s32 n = 0; n < count; ++n) result.part_number_sum += schematic.values[neighbours[n]];
+        if (count == 2) result.gear_ratio_sum += schematic.values[neighbours[0]] * schematic.values[neighbours[1]];
+    }
+    return result;
+}
 
+/**
+ * The same sweep, for schematics that are read a line at a time and never held in memory all at once. Only
+ * the last three rows are kept, and a row is swept once the row below it arrives, so memory depends on the
+ * width of the schematic and not its height:
+ *
+ * RowWindow window = {};
+ * while (...) window.Push(line);
+ * window.Finish(); // Sweeps the last row. The answers are in window.result.
+ *
+ * There's no label grid here, so a symbol reads its neighbouring numbers straight out of the rows instead.
+ * Each row is stored with a '.' either side of it, and a blank row stands in above the first row and below
+ * the last one, so that doesn't need bounds checks either.
+ */
+struct RowWindow
+{
+    s64 width;
+    TArray<char> cells; // Four padded rows: the blank one, then the last three rows pushed, round robin.
+    RowMasks masks; // For the row being swept.
+    s64 rows; // Rows pushed so far.
+    SweepResult result;
+
+    // First cell of row y's slot, or of the blank row if y is out of range.
+    char* Row(s64 y) {return &cells[(tarray_int)(((y >= 0 && y < rows) ? 1 + y % 3 : 0) * (width + 2) + 1)];}
+
+    void Push(IString line);
+    void Finish();
+    void SweepRow(s64 y);
+};
+
+// The whole number that covers column x of a padded row.
+static s64 NumberAt(const char* row, s64 x)
+{
+    while (IsDigit(row[x - 1])) --x;
+    s64 value = 0;
+    for (; IsDigit(row[x]); ++x) value = value * 10 + (row[x] - '0');
+    return value;
+}
 
-    s32 result = 0;
-    // Iterate through all lines.
-    for (s32 line_idx = 0; line_idx < line_count; ++line_idx)
+void RowWindow::Push(IString line)
+{
+    if (!rows)
     {
-        char* line = buf + start_offset + (line_stride *  line_idx);
+        width = (s64)line.Length();
+        AssertCustom(width > 0, "Expected every line to be the same width.");
+        cells = TArray<char>((tarray_int)(4 * (width + 2)));
+        memset(cells.begin(), '.', cells.Length());
+        masks.words_per_row = (width + 63) / 64;
+        masks.digits = TArray<u64>((tarray_int)masks.words_per_row);
+        masks.symbols = TArray<u64>((tarray_int)masks.words_per_row);
+    }
+    AssertCustom((s64)line.Length() == width, "Expected every line to be the same width.");
+
+    rows += 1;
+    memcpy(Row(rows - 1), line.Ptr(), width);
+    if (rows > 1) SweepRow(rows - 2);
+}
 
-        // Iterate through characters, looking for symbols.
-        for (s32 i = 0; i < line_length; ++i)
+void RowWindow::Finish()
+{
+    if (rows) SweepRow(rows - 1);
+}
+
+// Same counting as SweepSymbols(): a run of digits in one of the three rows is one number, so a neighbour
+// is new whenever the cell before it in its row wasn't a digit.
+void RowWindow::SweepRow(s64 y)
+{
+    const char* neighbour_rows[3] = {Row(y - 1), Row(y), Row(y + 1)};
+    Simd::Dispatch<BuildRowMasks>(neighbour_rows[1], width, width, (s64)1, &masks);
+    for (s64 word = 0; word < masks.words_per_row; ++word)
+    {
+        for (u64 bits = masks.symbols[(tarray_int)word]; bits; bits &= bits - 1)
         {
-            if (IsSymbol(line[i]))
+            s64 x = word * 64 + Simd::CountTrailingZeros(bits);
+            s64 neighbours[8];
+            s32 count = 0;
+            for (const char* row : neighbour_rows)
             {
-                s32 accumulator = 1;
-                s32 counter = 0;
-                // Scan for nearby numbers.
-                for (s32 y = -1; y <= 1; ++y)
+                bool previous = false;
+                for (s64 dx = -1; dx <= 1; ++dx)
                 {
-                    for (s32 x = -1; x <= 1; ++x)
-                    {
-                        s32 j = i + x + (line_stride * y);
-
-                        if (IsDigit(line[j]))
-                        {
-                            // Scan left to find the start of the number.
-                            s32 start_idx = j;
-                            while (IsDigit(line[start_idx])) --start_idx;
-                            ++start_idx;
-
-                            s32 number = ParseNumber(line, &start_idx);
-
-                            accumulator *= number;
-                            ++counter;
-                            // Scan right to skip the remainder of the number.
-                            while (IsDigit(line[j])) {++j;++x;}
-                        }
-                    }
+                    bool digit = IsDigit(row[x + dx]);
+                    if (digit && !previous) neighbours[count++] = NumberAt(row, x + dx);
+                    previous = digit;
                 }
-
-                if (counter == 2) result += accumulator;
             }
+
+            for (s32 n = 0; n < count; ++n) result.part_number_sum += neighbours[n];
+            if (count == 2) result.gear_ratio_sum += neighbours[0] * neighbours[1];
         }
     }
-
-    free(buf);
-    return result;
 }
 
 int main(int argc, char* argv[])
 {
+    // Arguments are the input path (optional), and:
+    // --stream    Read the file a block at a time and sweep it through a three row window, so it never has to
+    //             be in memory all at once. Both parts come out of the same pass, so they're timed together.
+    IString path = DEFAULT_INPUT_PATH;
+    bool stream = false;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        if (arg == "--stream") stream = true;
+        else path = arg;
+    }
+
+    if (stream)
+    {
+        Jobs::Start();
+        Platform::Timer timer = {};
+        Platform::TimerStart(&timer);
+
+        LineStream lines = {};
+        if (!lines.Open(path, StreamBlockSize))
+        {
+            PrintF("Couldn't open %.*s\n", (s32)path.Length(), path.Ptr());
+            Jobs::Stop();
+            return 1;
+        }
+        RowWindow window = {};
+        IString block;
+        while (lines.Next(&block))
+        {
+            LineIterator it = {block};
+            IString line;
+            while (it.Next(&line)) window.Push(line);
+        }
+        window.Finish();
+        if (lines.failed) PrintLog("Couldn't read the whole input!\n");
+        lines.Close();
+
+        u64 us = Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer));
+        PrintF("Part 1: %lld\nPart 2: %lld\n(Both computed in one streaming pass, in %lldus)\n", window.result.part_number_sum, window.result.gear_ratio_sum, us);
+        Jobs::Stop();
+        return 0;
+    }
+
     // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
     Span<u8> input_file = Platform::ReadFileToBuffer(path);
 
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s32 part1 = DoPartOne({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    // Label every number once, then one sweep over the symbols answers both parts.
+    Schematic schematic = LabelNumbers({(char*)input_file.ptr, (u32)input_file.count});
+    u64 label_counts = Platform::TimerMeasureCounts(&timer);
 
-    s32 part2 = DoPartTwo({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+    SweepResult sweep = SweepSymbols(schematic);
+    u64 sweep_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+    u64 label_us = Platform::TimerCountsToMicroseconds(&timer, label_counts);
+    u64 sweep_us = Platform::TimerCountsToMicroseconds(&timer, sweep_counts - label_counts);
 
     // Print results.
-    PrintF("Part 1: %d (Computed in %lldus)\nPart 2: %d (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
+    PrintF("Labelled in %lldus\nPart 1: %lld\nPart 2: %lld\n(Both computed in one sweep, in %lldus)\n", label_us, sweep.part_number_sum, sweep.gear_ratio_sum, sweep_us);
     // Free the input file and exit.
     free(input_file.ptr);
     return 0;
 }
-
-
@@ -4,87 +4,126 @@
 
 #define DEFAULT_INPUT_PATH "input.txt"
 
-s32 NumberOfBInA(const TArray<s32>& a, const TArray<s32>& b)
+/**
+ * Where everything is on a card. Every line of the input has the same layout, so it's worked out once from
+ * the first line, and every card after that is read at fixed offsets:
+ *
+ * Card   1: 78 66 68 | 9 79 96 51
+ *         ^          ^
+ *       colon       bar
+ *
+ * Each number is a 2 character field (space padded on the left) with a space in front of it, so both sides
+ * are runs of 3 character fields. Any number of cards, and any number of fields on either side, will do.
+ */
+struct CardLayout
 {
-    s32 result = 0;
-    for (s32 val : b) if (a.Contains(val)) ++result;
+    s64 stride; // Line width, including the newline.
+    s64 card_count;
+    s64 colon;
+    s64 bar;
+    s64 winning_count;
+    s64 held_count;
+};
+
+static CardLayout FindCardLayout(IString input)
+{
+    const char* text = input.Ptr();
+    s64 length = (s64)input.Length();
+    while (length && text[length - 1] == '\n') --length; // The last line doesn't need a newline, or can have blank lines after it.
+    const char* newline = (const char*)memchr(text, '\n', length);
+    s64 width = (newline) ? newline - text : length;
+    const char* colon = (const char*)memchr(text, ':', width);
+    const char* bar = (const char*)memchr(text, '|', width);
+    AssertCustom(colon && bar && colon < bar, "Card doesn't match the expected format.");
+
+    CardLayout result = {};
+    result.stride = width + 1;
+    result.colon = colon - text;
+    result.bar = bar - text;
+    result.winning_count = (result.bar - result.colon - 2) / 3;
+    result.held_count = (width - result.bar - 1) / 3;
+    AssertCustom(result.winning_count * 3 + 2 == result.bar - result.colon && result.held_count * 3 + 1 == width - result.bar,
+                 "Expected every number to be a 2 character field.");
+
+    result.card_count = (length + 1) / result.stride;
+    AssertCustom((length + 1) % result.stride == 0, "Expected every line to be the same width.");
     return result;
 }
 
-static s32 DoPartOne(IString input)
+// Sets the bit for one 2 character field in a 128-bit mask, kept as two words so both can stay in registers.
+// The tens are a space below 10, and both a space (0x20) and '0'-'9' have their value in the low 4 bits, so
+// no field needs a branch. Returns nonzero if the field wasn't a number. Marked inline, since otherwise GCC
+// stops inlining it once every backend's kernel calls it.
+static inline u32 AddFieldToMask(const char* field, u64* low, u64* high)
 {
-    s32 total_score = 0;
-    s32 line_length = (s32)(strchr(input.Ptr(), '\n') - input.Ptr());
-    TArray<s32> winning_numbers = TArray<s32>(10);
-    TArray<s32>your_numbers = TArray<s32>(25);
-    for (s32 offset = 0; offset < input.Length(); offset += (line_length + 1))
-    {
-        const char* line = input.Ptr() + offset;
-
-        s32 game_number;
-
-        s32* a = &winning_numbers[0];
-        s32* b = &your_numbers[0];
-
-        // This is what clean code looks like.
-        sscanf(line, "Card %d: %d %d %d %d %d %d %d %d %d %d | %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
-        &game_number,
-        a, a+1, a+2, a+3, a+4, a+5, a+6, a+7, a+8, a+9,
-        b, b+1, b+2, b+3, b+4, b+5, b+6, b+7, b+8, b+9,
-        b+10, b+11, b+12, b+13, b+14, b+15, b+16, b+17,
-        b+18, b+19, b+20, b+21, b+22, b+23, b+24);
+    u8 tens = (u8)field[0];
+    u8 ones = (u8)field[1];
+    u32 value = (tens & 15) * 10 + (ones & 15);
+    u64 bit = 1ull << (value & 63);
+    u64 in_high = 0ull - (value >> 6);
+    *low |= bit & ~in_high;
+    *high |= bit & in_high;
+    return ((u8)(ones - '0') > 9) | ((tens != ' ') & ((u8)(tens - '0') > 9));
+}
 
-        s32 match_count = NumberOfBInA(winning_numbers, your_numbers);
-        s32 score = (match_count) ? (1 << (match_count - 1)) : 0;
-        total_score += score;
-        PrintF("Game %d: Score %d, match count %d\n", game_number, score, match_count);
+// Every number on a card is below 100, so each side of it fits in two 64-bit words, one bit per number.
+// The numbers a card matches are then just the bits both sides have, two ANDs and two popcounts. Cards are
+// independent, so there's no dependency from one to the next and they pipeline well. Malformed cards are
+// collected along the way, and checked once at the end.
+struct CountMatches
+{
+    template <typename Backend> static u32 Run(const char* text, const CardLayout& layout, Span<s32> out)
+    {
+        u32 bad = 0;
+        for (s64 card = 0; card < layout.card_count; ++card)
+        {
+            const char* line = text + card * layout.stride;
+            bad |= (line[layout.colon] != ':') | (line[layout.bar] != '|');
+
+            u64 winning_low = 0, winning_high = 0;
+            u64 held_low = 0, held_high = 0;
+            for (s64 field = 0; field < layout.winning_count; ++field) bad |= AddFieldToMask(line + layout.colon + 2 + field * 3, &winning_low, &winning_high);
+            for (s64 field = 0; field < layout.held_count; ++field) bad |= AddFieldToMask(line + layout.bar + 2 + field * 3, &held_low, &held_high);
+            out[card] = Backend::PopCount(winning_low & held_low) + Backend::PopCount(winning_high & held_high);
+        }
+        return bad;
     }
-    return total_score;
-}
+};
 
-static s32 ComputeScoreRecursive(const TArray<s32>& games, s32 game_idx)
+static TArray<s32> MatchCards(IString input)
 {
-    s32 additional_games = games[game_idx];
-    s32 added_score = additional_games;
-    for (s32 i = 1; i <= additional_games; ++i) added_score += ComputeScoreRecursive(games, game_idx + i);
-    return added_score;
+    CardLayout layout = FindCardLayout(input);
+    TArray<s32> result = TArray<s32>((tarray_int)layout.card_count);
+    u32 bad = Simd::Dispatch<CountMatches>(input.Ptr(), layout, Span<s32>(result.begin(), result.Length()));
+    AssertCustom(!bad, "Card doesn't match the expected format.");
+    return result;
 }
 
-static s32 DoPartTwo(IString input)
+static s64 DoPartOne(const TArray<s32>& matches)
 {
-    s32 line_length = (s32)(strchr(input.Ptr(), '\n') - input.Ptr());
-    TArray<s32> winning_numbers = TArray<s32>(10);
-    TArray<s32>your_numbers = TArray<s32>(25);
-
-    TArray<s32> games = {};
+    s64 total_score = 0;
+    for (s32 match_count : matches) total_score += (match_count) ? (1ll << (match_count - 1)) : 0;
+    return total_score;
+}
 
-    for (s32 offset = 0; offset < input.Length(); offset += (line_length + 1))
+// Each card wins one copy of each of the next match_count cards, for every copy of it there is. Copies
+// only ever go to later cards, so one pass front to back sees every card's final count before using it.
+static s64 DoPartTwo(const TArray<s32>& matches)
+{
+    s64 card_count = matches.Length();
+    TArray<s64> copies = TArray<s64>((tarray_int)card_count);
+    s64 total_cards = 0;
+    for (s64 card = 0; card < card_count; ++card)
     {
-        const char* line = input.Ptr() + offset;
-
-        s32 game_number;
-
-        s32* a = &winning_numbers[0];
-        s32* b = &your_numbers[0];
-
-        // This is what clean code looks like.
-        sscanf(line, "Card %d: %d %d %d %d %d %d %d %d %d %d | %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
-        &game_number,
-        a, a+1, a+2, a+3, a+4, a+5, a+6, a+7, a+8, a+9,
-        b, b+1, b+2, b+3, b+4, b+5, b+6, b+7, b+8, b+9,
-        b+10, b+11, b+12, b+13, b+14, b+15, b+16, b+17,
-        b+18, b+19, b+20, b+21, b+22, b+23, b+24);
-
-        s32 match_count = NumberOfBInA(winning_numbers, your_numbers);
-        games.Append(match_count);
+        s64 count = copies[(tarray_int)card] + 1; // The original, plus any copies won so far.
+        total_cards += count;
+        s64 last = card + matches[(tarray_int)card];
+        if (last >= card_count) last = card_count - 1;
+        for (s64 next = card + 1; next <= last; ++next) copies[(tarray_int)next] += count;
     }
-
-    s32 total_games = games.Length();
-    for (s32 i = 0; i < games.Length(); ++i) total_games += ComputeScoreRecursive(games, i);
-    return total_games;
+    return total_cards;
 }
 
-
 int main(int argc, char* argv[])
 {
     // Read the input file into a buffer.
@@ -95,22 +134,24 @@ int main(int argc, char* argv[])
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s32 part1 = DoPartOne({(char*)input_file.ptr, (u32)input_file.count});
+    // Count each card's matches once, and both parts work from the counts.
+    TArray<s32> matches = MatchCards({(char*)input_file.ptr, (u32)input_file.count});
+    u64 match_counts = Platform::TimerMeasureCounts(&timer);
+
+    s64 part1 = DoPartOne(matches);
     u64 part1_counts = Platform::TimerMeasureCounts(&timer);
 
-    s32 part2 = DoPartTwo({(char*)input_file.ptr, (u32)input_file.count});
+    s64 part2 = DoPartTwo(matches);
     u64 part2_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
+    u64 match_us = Platform::TimerCountsToMicroseconds(&timer, match_counts);
+    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts - match_counts);
     u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
 
     // Print results.
-    PrintF("Part 1: %d (Computed in %lldus)\nPart 2: %d (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
+    PrintF("Matched in %lldus\nPart 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\n", match_us, part1, part1_us, part2, part2_us);
     // Free the input file and exit.
     free(input_file.ptr);
     return 0;
 }
-
-
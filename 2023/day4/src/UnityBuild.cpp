@@ -2,5 +2,6 @@
 #include "Core/EngineCore.h"
 
 #include "Core/EngineCore.cpp"
+#include "Core/Simd.cpp"
 #include "Platform/Platform.cpp"
 #include "Main.cpp"
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "Core/Parse.h"
+#include "Platform/Platform.h"
+
+#if defined _M_X64 || defined __SSE2__
+#define PARSE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ParseInternal
+{
+static const u64 PowersOfTen[] =
+{
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+    1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull
+};
+
+#ifdef _MSC_VER
+static inline s32 CountTrailingZeros(u64 value) {unsigned long index; _BitScanForward64(&index, value); return (s32)index;}
+#else
+static inline s32 CountTrailingZeros(u64 value) {return __builtin_ctzll(value);}
+#endif
+
+// Number of leading digit characters in 8 bytes of text (first character in the lowest byte).
+static inline s32 CountDigits8(u64 chunk)
+{
+    // A byte is a digit if it is >= '0' and, after adding 0x46, hasn't reached 0x80 (so it is <= '9').
+    // Either test failing sets the top bit of that byte.
+    u64 not_digits = ((chunk - 0x3030303030303030ull) | (chunk + 0x4646464646464646ull)) & 0x8080808080808080ull;
+    return (not_digits) ? CountTrailingZeros(not_digits) / 8 : 8;
+}
+
+// Value of the first count digits of chunk, where 1 <= count <= 8.
+static inline u64 ParseDigits8(u64 chunk, s32 count)
+{
+    // Shift the digits to the top, so the bytes we don't want fall off and the bottom fills with zeros
+    // (which read as leading zeros). Then combine pairs, quads, and octets with one multiply each.
+    chunk <<= (8 - count) * 8;
+    chunk = ((chunk & 0x0f0f0f0f0f0f0f0full) * 2561) >> 8;
+    chunk = ((chunk & 0x00ff00ff00ff00ffull) * 6553601) >> 16;
+    return ((chunk & 0x0000ffff0000ffffull) * 42949672960001ull) >> 32;
+}
+
+#ifdef PARSE_SSE2
+// Parses up to 16 digits at ptr (which must have 16 readable bytes) into *out_value, and returns the digit count.
+static inline s32 ParseDigits16(const char* ptr, u64* out_value)
+{
+    __m128i digits = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)ptr), _mm_set1_epi8('0'));
+    // Anything that wasn't '0'..'9' wrapped around to a value above 9.
+    u32 is_digit = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(digits, _mm_set1_epi8(9)), _mm_setzero_si128()));
+    s32 count = (s32)CountTrailingZeros(~(u64)is_digit);
+    if (count == 0) {*out_value = 0; return 0;}
+
+    // Right-align the digits by bouncing them through a zero-padded buffer, so the unused
+    // lanes become leading zeros. This avoids needing a variable byte shift.
+    alignas(16) u8 buffer[32] = {};
+    _mm_store_si128((__m128i*)(buffer + 16), digits);
+    digits = _mm_loadu_si128((const __m128i*)(buffer + count));
+
+    // Combine adjacent lanes: 16 digits -> 8 pairs -> 4 quads -> 2 octets.
+    __m128i lo = _mm_unpacklo_epi8(digits, _mm_setzero_si128());
+    __m128i hi = _mm_unpackhi_epi8(digits, _mm_setzero_si128());
+    __m128i tens = _mm_setr_epi16(10, 1, 10, 1, 10, 1, 10, 1);
+    __m128i pairs = _mm_packs_epi32(_mm_madd_epi16(lo, tens), _mm_madd_epi16(hi, tens));
+    __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    quads = _mm_packs_epi32(quads, quads);
+    __m128i octets = _mm_madd_epi16(quads, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+    u64 high = (u32)_mm_cvtsi128_si32(octets);
+    u64 low = (u32)_mm_cvtsi128_si32(_mm_srli_si128(octets, 4));
+    *out_value = high * 100000000ull + low;
+    return count;
+}
+#endif
+} // namespace ParseInternal
+
+u64 ParseUnsigned(IString input, s64* offset)
+{
+    const char* ptr = input.Ptr() + *offset;
+    s64 available = (s64)input.Length() - *offset;
+    u64 result = 0;
+
+    // Each step consumes every digit in its window. If it used the whole window, the number might continue.
+    while (available >= 8)
+    {
+        u64 chunk;
+        memcpy(&chunk, ptr, 8);
+        s32 count = ParseInternal::CountDigits8(chunk);
+        s32 window = 8;
+        u64 value = 0;
+#ifdef PARSE_SSE2
+        if (count == 8 && available >= 16)
+        {
+            window = 16;
+            count = ParseInternal::ParseDigits16(ptr, &value);
+        }
+        else
+#endif
+        if (count) value = ParseInternal::ParseDigits8(chunk, count);
+
+        result = result * ParseInternal::PowersOfTen[count] + value;
+        ptr += count;
+        available -= count;
+        if (count < window) break;
+    }
+
+    // Fewer than 8 bytes left in the input, finish off one digit at a time.
+    if (available < 8)
+    {
+        while (available > 0 && IsDigit(*ptr))
+        {
+            result = result * 10 + (*ptr - '0');
+            ++ptr;
+            --available;
+        }
+    }
+
+    *offset = ptr - input.Ptr();
+    return result;
+}
+
+s64 ParseSigned(IString input, s64* offset)
+{
+    s64 start = *offset;
+    bool is_negative = (start < (s64)input.Length() && input.Ptr()[start] == '-');
+    *offset += is_negative;
+    u64 magnitude = ParseUnsigned(input, offset);
+    if (*offset == start + is_negative) *offset = start; // Just a '-' on its own isn't a number.
+
+    s64 sign = -(s64)is_negative; // All ones if negative, so we can negate without a branch.
+    return ((s64)magnitude ^ sign) - sign;
+}
+
+s64 FindNextDigit(IString input, s64 offset)
+{
+    s64 length = (s64)input.Length();
+#ifdef PARSE_SSE2
+    // Skip separators 16 bytes at a time.
+    for (; offset + 16 <= length; offset += 16)
+    {
+        __m128i digits = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)(input.Ptr() + offset)), _mm_set1_epi8('0'));
+        u32 is_digit = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(digits, _mm_set1_epi8(9)), _mm_setzero_si128()));
+        if (is_digit) return offset + ParseInternal::CountTrailingZeros(is_digit);
+    }
+#endif
+    while (offset < length && !IsDigit(input.Ptr()[offset])) ++offset;
+    return offset;
+}
+
+void ParseAllIntegers(IString input, TArray<s64>* out_numbers)
+{
+    Assert(out_numbers);
+    s64 length = (s64)input.Length();
+    s64 offset = FindNextDigit(input, 0);
+    while (offset < length)
+    {
+        bool is_negative = (offset > 0 && input.Ptr()[offset - 1] == '-');
+        u64 magnitude = ParseUnsigned(input, &offset);
+        out_numbers->Append((is_negative) ? -(s64)magnitude : (s64)magnitude);
+        offset = FindNextDigit(input, offset);
+    }
+}
+
+TArray<s64> ParseAllIntegers(IString input)
+{
+    TArray<s64> result = {};
+    ParseAllIntegers(input, &result);
+    return result;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// Integer parsing. These all follow the same convention as the old per-day ParseNumber() functions:
+// parsing starts at *offset, and *offset is advanced to the first character after the number. They
+// never read past the end of the input, and they don't skip leading whitespace.
+//
+// Numbers of up to 8 digits are parsed with one SWAR (SIMD-within-a-register) step, and longer ones
+// 16 digits at a time with SSE2, so there is no per-digit loop or branch on the common path.
+// Overflow is not detected, numbers that don't fit in 64 bits just wrap.
+
+inline bool IsDigit(char c) {return (c >= '0' && c <= '9');}
+
+// Parses an unsigned decimal number. Returns 0 and leaves *offset alone if there is no digit at *offset.
+u64 ParseUnsigned(IString input, s64* offset);
+
+// Same as ParseUnsigned(), but accepts a single leading '-'.
+s64 ParseSigned(IString input, s64* offset);
+
+// Returns the offset of the first digit at or after offset, or input.Length() if there isn't one.
+s64 FindNextDigit(IString input, s64 offset);
+
+// Extracts every integer in the input, in order. Anything that isn't a digit is treated as a separator,
+// and a '-' directly in front of a number makes it negative. Handy for inputs like "Time: 7 15 30".
+TArray<s64> ParseAllIntegers(IString input);
+void ParseAllIntegers(IString input, TArray<s64>* out_numbers); // Appends instead of allocating a new array.
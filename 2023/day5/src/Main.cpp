@@ -1,8 +1,8 @@
-
 #include "Core/EngineCore.h"
 #include "Platform/Platform.h"
 
 #define DEFAULT_INPUT_PATH "input.txt"
+#define MAP_COUNT 7
 
 struct Range
 {
@@ -11,15 +11,28 @@ struct Range
     s64 length;
 };
 
-static bool IsDigit(char c) {return (c >= '0' && c <= '9');}
-static void SkipToNextDigit(char** input) {while (!IsDigit(*(*input))) ++(*input);}
-static Range ParseRange(char** input)
+// The seed numbers, and the seven maps in the order they are followed (seed to soil, soil to fertilizer,
+// and so on down to humidity to location). Part one treats the seeds as values, part two as (start, length) pairs.
+struct ParsedInput
+{
+    TArray<s64> seeds;
+    TArray<Range> maps[MAP_COUNT];
+};
+
+// Parses a number, skipping any spaces in front of it.
+static s64 ParseValue(IString input, s64* offset)
+{
+    while (*offset < (s64)input.Length() && input[*offset] == ' ') *offset += 1;
+    return (s64)ParseUnsigned(input, offset);
+}
+
+static Range ParseRange(IString input, s64* offset)
 {
     Range result = {};
-    result.dst = strtoll(*input, input, 10);
-    result.src = strtoll(*input, input, 10);
-    result.length = strtoll(*input, input, 10);
-    *input += 1;
+    result.dst = ParseValue(input, offset);
+    result.src = ParseValue(input, offset);
+    result.length = ParseValue(input, offset);
+    *offset += 1;
     return result;
 }
 
@@ -35,103 +48,51 @@ static s64 FollowMap(const TArray<Range>& map, s64 key)
     return key;
 }
 
-static s64 DoPartOne(IString input)
+static ParsedInput Parse(Span<const char> input_text)
 {
-    char* next = (char*)input.Ptr(); // const cast, oof
-    SkipToNextDigit(&next);
-    TArray<s64> seeds = {};
-    while (*next != '\n')
-    {
-        s64 i = strtoll(next, &next, 10);
-        seeds.Append(i);
-    }
-
-    SkipToNextDigit(&next);
-    TArray<Range> seed_to_soil = {};
-    while (*next != '\n') seed_to_soil.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> soil_to_fertilizer = {};
-    while (*next != '\n') soil_to_fertilizer.Append(ParseRange(&next));
+    IString input = {input_text.ptr, (u32)input_text.count};
+    ParsedInput result = {};
 
-    SkipToNextDigit(&next);
-    TArray<Range> fertilizer_to_water = {};
-    while (*next != '\n') fertilizer_to_water.Append(ParseRange(&next));
+    s64 offset = 0;
+    offset = FindNextDigit(input, offset);
+    while (input[offset] != '\n') result.seeds.Append(ParseValue(input, &offset));
 
-    SkipToNextDigit(&next);
-    TArray<Range> water_to_light = {};
-    while (*next != '\n') water_to_light.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> light_to_temperature = {};
-    while (*next != '\n') light_to_temperature.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> temperature_to_humidity = {};
-    while (*next != '\n') temperature_to_humidity.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> humidity_to_location = {};
-    while ((next - input.Ptr()) < (s64)input.Length()) humidity_to_location.Append(ParseRange(&next));
+    // Every map but the last ends at a blank line. The last one ends with the input.
+    for (s32 i = 0; i < MAP_COUNT; ++i)
+    {
+        offset = FindNextDigit(input, offset);
+        TArray<Range>& map = result.maps[i];
+        if (i < MAP_COUNT - 1) while (input[offset] != '\n') map.Append(ParseRange(input, &offset));
+        else while (offset < (s64)input.Length()) map.Append(ParseRange(input, &offset));
+    }
+    return result;
+}
 
+static s64 DoPartOne(const ParsedInput& input)
+{
     s64 smallest_location = S64_MAX;
 
-    for (s64 seed : seeds)
+    for (s64 seed : input.seeds)
     {
-        s64 soil = FollowMap(seed_to_soil, seed);
-        s64 fertilizer = FollowMap(soil_to_fertilizer, soil);
-        s64 water = FollowMap(fertilizer_to_water, fertilizer);
-        s64 light = FollowMap(water_to_light, water);
-        s64 temperature = FollowMap(light_to_temperature, light);
-        s64 humidity = FollowMap(temperature_to_humidity, temperature);
-        s64 location = FollowMap(humidity_to_location, humidity);
+        s64 location = seed;
+        for (const TArray<Range>& map : input.maps) location = FollowMap(map, location);
 
         if (location < smallest_location) smallest_location = location;
     }
     return smallest_location;
 }
 
-static s64 DoPartTwo(IString input)
+static s64 DoPartTwo(const ParsedInput& input)
 {
-char* next = (char*)input.Ptr(); // const cast, oof
-    SkipToNextDigit(&next);
     TArray<Range> seeds = {};
-    while (*next != '\n')
+    for (s32 i = 0; i + 1 < input.seeds.Length(); i += 2)
     {
         Range r = {};
-        r.src = strtoll(next, &next, 10);
-        r.length = strtoll(next, &next, 10);
+        r.src = input.seeds[i];
+        r.length = input.seeds[i + 1];
         seeds.Append(r);
     }
 
-    SkipToNextDigit(&next);
-    TArray<Range> seed_to_soil = {};
-    while (*next != '\n') seed_to_soil.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> soil_to_fertilizer = {};
-    while (*next != '\n') soil_to_fertilizer.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> fertilizer_to_water = {};
-    while (*next != '\n') fertilizer_to_water.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> water_to_light = {};
-    while (*next != '\n') water_to_light.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> light_to_temperature = {};
-    while (*next != '\n') light_to_temperature.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> temperature_to_humidity = {};
-    while (*next != '\n') temperature_to_humidity.Append(ParseRange(&next));
-
-    SkipToNextDigit(&next);
-    TArray<Range> humidity_to_location = {};
-    while ((next - input.Ptr()) < (s64)input.Length()) humidity_to_location.Append(ParseRange(&next));
-
     s64 smallest_location = S64_MAX;
 
     s64 sum_of_ranges = 0;
@@ -142,45 +103,82 @@ char* next = (char*)input.Ptr(); // const cast, oof
         // PrintF("Doing the next range...\n");
         // for (s64 s = seed_range.src; s < seed_range.src + seed_range.length; ++s)
         // {
-        //     s64 soil = FollowMap(seed_to_soil, s);
-        //     s64 fertilizer = FollowMap(soil_to_fertilizer, soil);
-        //     s64 water = FollowMap(fertilizer_to_water, fertilizer);
-        //     s64 light = FollowMap(water_to_light, water);
-        //     s64 temperature = FollowMap(light_to_temperature, light);
-        //     s64 humidity = FollowMap(temperature_to_humidity, temperature);
-        //     s64 location = FollowMap(humidity_to_location, humidity);
+        //     s64 location = s;
+        //     for (const TArray<Range>& map : input.maps) location = FollowMap(map, location);
         //     if (location < smallest_location) smallest_location = location;
         // }
     }
     return smallest_location;
 }
 
+typedef s64 PartFunction(const ParsedInput& input);
+
+struct PartRun
+{
+    PartFunction* function;
+    const ParsedInput* input;
+    s64 result;
+    u64 us;
+};
+
+// Runs and times one part. Takes a void* so that it can also be a thread's entry point.
+static void RunPart(void* data)
+{
+    PartRun* run = (PartRun*)data;
+    Platform::Timer timer = {};
+    Platform::TimerStart(&timer);
+    run->result = run->function(*run->input);
+    run->us = Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer));
+}
+
 int main(int argc, char* argv[])
 {
+    // Arguments are the input path (optional), and --concurrent to run the two parts at the same time.
+    IString path = DEFAULT_INPUT_PATH;
+    bool concurrent = false;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        if (arg == "--concurrent") concurrent = true;
+        else path = arg;
+    }
+
     // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
     Span<u8> input_file = Platform::ReadFileToBuffer(path);
 
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s64 part1 = DoPartOne({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    // Parse once, for both parts.
+    ParsedInput parsed = Parse({(const char*)input_file.ptr, input_file.count});
+    u64 parse_counts = Platform::TimerMeasureCounts(&timer);
 
-    s64 part2 = DoPartTwo({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+    // Do the actual work. Concurrently, part two gets a thread of its own while part one runs on this one.
+    PartRun part1 = {DoPartOne, &parsed};
+    PartRun part2 = {DoPartTwo, &parsed};
+    if (concurrent)
+    {
+        Platform::Thread thread = Platform::StartThread(RunPart, &part2);
+        AssertCustom(thread.handle, "Failed to start a thread for part two.");
+        RunPart(&part1);
+        Platform::JoinThread(&thread);
+    }
+    else
+    {
+        RunPart(&part1);
+        RunPart(&part2);
+    }
+    u64 total_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+    u64 parse_us = Platform::TimerCountsToMicroseconds(&timer, parse_counts);
+    u64 total_us = Platform::TimerCountsToMicroseconds(&timer, total_counts);
 
     // Print results.
-    PrintF("Part 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
+    PrintF("Parsed in %lldus\nPart 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\nTotal: %lldus%s\n",
+           parse_us, part1.result, part1.us, part2.result, part2.us, total_us, concurrent ? " (parts ran concurrently)" : "");
     // Free the input file and exit.
     free(input_file.ptr);
     return 0;
 }
-
-
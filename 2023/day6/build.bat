@@ -6,7 +6,7 @@ REM Set build tool and library paths as well as compile flags here.
 
 set debug_flags=/Od /Z7 /MTd
 set release_flags=/O2 /GL /MT /analyze- /D NDEBUG
-set common_flags=/W3 /Gm- /EHsc /nologo /Fe: Engine.exe /I ..\..\src ..\..\src\UnityBuild.cpp
+set common_flags=/std:c++20 /W3 /Gm- /EHsc /nologo /Fe: Engine.exe /I ..\..\src ..\..\src\UnityBuild.cpp
 set linker_flags=/INCREMENTAL:no /NOLOGO /SUBSYSTEM:CONSOLE user32.lib
 
 REM Run the build tools, but only if they aren't set up already.
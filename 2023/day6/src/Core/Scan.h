@@ -0,0 +1,143 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// A scanf replacement for structured lines, where the format string is parsed at compile time instead of
+// being interpreted on every call. Each piece of the format becomes its own bit of inlined code, so
+// something like Scan<"Card %d: %10d | %25d">(line, &offset, &card, winning, yours) ends up about the
+// same as a hand written parser for that line. Needs C++20, since the format is a template parameter.
+//
+// Format syntax:
+// - %d reads a signed integer, %u an unsigned one. The output can be a pointer to any integer type.
+// - %Nd or %Nu reads N integers into consecutive elements, starting at the output pointer.
+// - %% matches a literal '%'.
+// - A space matches any run of spaces and tabs (including an empty one). Conversions also skip spaces
+//   in front of them, so runs of padding between numbers don't need to be spelled out.
+// - Anything else (including '\n') has to match exactly.
+//
+// Parsing starts at *offset, and *offset is left after the last thing matched. If the input doesn't match,
+// Scan() returns false and *offset is left where matching failed. Having a different number of outputs
+// than conversions in the format is a compile error.
+
+namespace ScanInternal
+{
+template <s64 N> struct Format
+{
+    char text[N];
+
+    constexpr Format(const char (&str)[N]) {for (s64 i = 0; i < N; ++i) text[i] = str[i];}
+    constexpr s64 Length() const {return N - 1;} // Not counting the null terminator.
+};
+
+constexpr bool IsSpace(char c) {return (c == ' ' || c == '\t');}
+
+// A %[count]type conversion, and the format position just after it.
+struct Conversion
+{
+    s64 count;
+    char type;
+    s64 end;
+};
+
+template <s64 N> constexpr Conversion ParseConversion(const Format<N>& format, s64 pos)
+{
+    Conversion result = {0, 0, pos + 1};
+    while (result.end < format.Length() && format.text[result.end] >= '0' && format.text[result.end] <= '9')
+    {
+        result.count = result.count * 10 + (format.text[result.end] - '0');
+        ++result.end;
+    }
+    if (result.end < format.Length()) result.type = format.text[result.end++];
+    if (result.count == 0) result.count = 1;
+    return result;
+}
+
+// End of the run of literal characters starting at pos.
+template <s64 N> constexpr s64 LiteralEnd(const Format<N>& format, s64 pos)
+{
+    while (pos < format.Length() && format.text[pos] != '%' && !IsSpace(format.text[pos])) ++pos;
+    return pos;
+}
+
+template <s64 N> constexpr s64 SpaceEnd(const Format<N>& format, s64 pos)
+{
+    while (pos < format.Length() && IsSpace(format.text[pos])) ++pos;
+    return pos;
+}
+
+template <s64 N> constexpr s64 CountConversions(const Format<N>& format)
+{
+    s64 result = 0;
+    for (s64 pos = 0; pos < format.Length(); ++pos)
+    {
+        if (format.text[pos] != '%') continue;
+        if (pos + 1 < format.Length() && format.text[pos + 1] == '%') ++pos;
+        else ++result;
+    }
+    return result;
+}
+
+inline void SkipSpaces(IString input, s64* offset)
+{
+    while (*offset < (s64)input.Length() && IsSpace(input.Ptr()[*offset])) *offset += 1;
+}
+
+template <char Type, typename T> inline bool ReadInteger(IString input, s64* offset, T* out)
+{
+    static_assert(Type == 'd' || Type == 'u', "Scan only supports %d and %u conversions.");
+    SkipSpaces(input, offset);
+    s64 start = *offset;
+    if constexpr (Type == 'd') *out = (T)ParseSigned(input, offset);
+    else *out = (T)ParseUnsigned(input, offset);
+    return (*offset != start);
+}
+
+template <Format F, s64 Pos, typename... Outputs> inline bool ScanFrom(IString input, s64* offset, Outputs*... outputs);
+
+template <Format F, s64 Pos, typename First, typename... Rest>
+inline bool ScanConversion(IString input, s64* offset, First* first, Rest*... rest)
+{
+    constexpr Conversion conversion = ParseConversion(F, Pos);
+    for (s64 i = 0; i < conversion.count; ++i)
+    {
+        if (!ReadInteger<conversion.type>(input, offset, first + i)) return false;
+    }
+    return ScanFrom<F, conversion.end>(input, offset, rest...);
+}
+
+template <Format F, s64 Pos, typename... Outputs> inline bool ScanFrom(IString input, s64* offset, Outputs*... outputs)
+{
+    if constexpr (Pos >= F.Length())
+    {
+        return true;
+    }
+    else if constexpr (IsSpace(F.text[Pos]))
+    {
+        SkipSpaces(input, offset);
+        return ScanFrom<F, SpaceEnd(F, Pos)>(input, offset, outputs...);
+    }
+    else if constexpr (F.text[Pos] == '%' && F.text[Pos + 1] != '%')
+    {
+        return ScanConversion<F, Pos>(input, offset, outputs...);
+    }
+    else
+    {
+        // A run of literal characters. "%%" is a literal '%', so match one character and carry on from there.
+        constexpr s64 end = (F.text[Pos] == '%') ? Pos + 1 : LiteralEnd(F, Pos);
+        constexpr s64 count = end - Pos;
+        if (*offset + count > (s64)input.Length()) return false;
+        for (s64 i = 0; i < count; ++i)
+        {
+            if (input.Ptr()[*offset + i] != F.text[Pos + i]) return false;
+        }
+        *offset += count;
+        return ScanFrom<F, end + (F.text[Pos] == '%')>(input, offset, outputs...);
+    }
+}
+} // namespace ScanInternal
+
+template <ScanInternal::Format F, typename... Outputs> inline bool Scan(IString input, s64* offset, Outputs*... outputs)
+{
+    static_assert(ScanInternal::CountConversions(F) == sizeof...(Outputs), "Scan needs one output per conversion in the format.");
+    return ScanInternal::ScanFrom<F, 0>(input, offset, outputs...);
+}
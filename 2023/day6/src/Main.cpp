@@ -12,7 +12,9 @@ static s64 DoPartOne(IString input)
     s64 times[4] = {};
     s64 distances[4] = {};
 
-    sscanf(input.Ptr(), "Time: %lld %lld %lld %lld\nDistance: %lld%lld%lld%lld", times, times+1, times+2, times+3, distances, distances+1, distances+2, distances+3);
+    s64 offset = 0;
+    bool parsed = Scan<"Time: %4d\nDistance: %4d">(input, &offset, times, distances);
+    AssertCustom(parsed, "Input doesn't match the expected format.");
 
     s64 result = 1;
     for (s64 race = 0; race < ARRAYCOUNT(times); ++race)
@@ -0,0 +1,52 @@
+#include "Core/Arena.h"
+#include "Platform/Platform.h"
+
+// Blocks only have malloc alignment, so this aligns the actual address rather than the offset.
+static s64 AlignedOffset(const char* base, s64 offset, s64 alignment)
+{
+    uintptr_t address = (uintptr_t)(base + offset);
+    uintptr_t aligned = (address + (uintptr_t)alignment - 1) & ~((uintptr_t)alignment - 1);
+    return offset + (s64)(aligned - address);
+}
+
+void* Arena::Allocate(s64 size, s64 alignment)
+{
+    Assert(size >= 0);
+    Assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    s64 start = (blocks.Length()) ? AlignedOffset(blocks[current].ptr, cursor, alignment) : 0;
+    if (!blocks.Length() || start + size > blocks[current].size)
+    {
+        // Move on to the next block if we already have one it fits in (kept from before a Reset()), otherwise
+        // make a new one right after the current block. Either way, leave room for the worst case alignment.
+        s32 next = (blocks.Length()) ? current + 1 : 0;
+        if (next >= blocks.Length() || size + alignment > blocks[next].size)
+        {
+            s64 block_size = (size + alignment > BlockSize) ? size + alignment : BlockSize;
+            Block block = {(char*)malloc(block_size), block_size}; // @malloc
+            if (next >= blocks.Length()) blocks.Append(block);
+            else blocks.Insert(block, next);
+        }
+        current = next;
+        cursor = 0;
+        start = AlignedOffset(blocks[current].ptr, 0, alignment);
+    }
+
+    used += (start + size) - cursor;
+    cursor = start + size;
+    return blocks[current].ptr + start;
+}
+
+void Arena::Reset()
+{
+    current = 0;
+    cursor = 0;
+    used = 0;
+}
+
+void Arena::Free()
+{
+    for (Block& block : blocks) free(block.ptr); // @malloc
+    blocks.Free();
+    Reset();
+}
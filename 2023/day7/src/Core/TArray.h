@@ -88,7 +88,7 @@ struct TArray
 
     // Frees the array memory.
     inline void Free();
-    ~TArray<T>() {Free();}
+    ~TArray() {Free();}
 
     // Checks if an item (or all items) are present. Requires == be defined.
     inline bool Contains(const T& element) const;
@@ -209,7 +209,7 @@ tarray_int TArray<T>::Insert(const T& element, tarray_int i)
 {
     TARRAY_ASSERT(i >= 0 && i <= length);
     if (capacity == 0) SetCapacity(TARRAY_INITIAL_CAPACITY);
-    else if (length > capacity) SetCapacity(capacity * 2);
+    else if (length == capacity) SetCapacity(capacity * 2);
     for (tarray_int j = length; j > i; --j) ptr[j] = ptr[j - 1];
     ptr[i] = element;
     return ++length;
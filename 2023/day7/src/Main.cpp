@@ -4,21 +4,6 @@
 
 #define DEFAULT_INPUT_PATH "input.txt"
 
-// Parses a number out of the input starting at offset, updating the offset to the end of the parsed number.
-// Doesn't parse negative numbers.
-static s32 ParseNumber(const char* input, s32* offset)
-{
-    s32 result = 0;
-    while (input[*offset] >= '0' && input[*offset] <= '9')
-    {
-        s32 digit = input[*offset] - '0';
-        result = result * 10 + digit;
-        *offset += 1;
-    }
-
-    return result;
-}
-
 enum class HandType
 {
     None = 0, // This is an error if we encounter it.
@@ -33,12 +18,36 @@ enum class HandType
 
 struct Hand
 {
-    char* cards;
+    const char* cards; // Points into the input. Always 5 cards, and not null terminated.
     HandType type;
     s32 bid;
 };
 
-HandType GetHandTypePartOne(Span<char> input, Hand hand, TArray<char>& card_buckets)
+// Hands in input order, with their types left as None. Each part fills in the types by its own rules,
+// on its own scratch copy, since it also sorts them.
+struct ParsedInput
+{
+    TArray<Hand> hands;
+};
+
+static ParsedInput Parse(Span<const char> input)
+{
+    ParsedInput result = {};
+    IString text = {input.ptr, (u32)input.count};
+    s64 offset = 0;
+    while (offset < input.count)
+    {
+        Hand hand = {};
+        hand.cards = &input[offset];
+        offset += 6; // Iterate past the hand (5 chars and then a space).
+        hand.bid = (s32)ParseUnsigned(text, &offset);
+        offset += 1; // Iterate past the newline.
+        result.hands.Append(hand);
+    }
+    return result;
+}
+
+HandType GetHandTypePartOne(Hand hand, TArray<char>& card_buckets)
 {
     // Create a bucket for each distinct type of card that we encounter.
     // Store the number of  cards in each bucket. For example, the hand AAJJ3
@@ -111,7 +120,7 @@ s32 HandComparatorPartOne(const void* p1, const void* p2)
     return score;
 }
 
-HandType GetHandTypePartTwo(Span<char> input, Hand hand, TArray<char>& card_buckets)
+HandType GetHandTypePartTwo(Hand hand, TArray<char>& card_buckets)
 {
     // Same as part one, create buckets and count the cards in each bucket.
     s32 bucket_counts[5] = {};
@@ -199,89 +208,109 @@ s32 HandComparatorPartTwo(const void* p1, const void* p2)
     return score;
 }
 
-static s64 DoPartOne(Span<char> input)
+static s64 DoPartOne(const ParsedInput& input, Arena* scratch)
 {
     // General strategy:
-    // 1. Iterate through lines to parse each hand (hand string, bid, and type).
-    // 2. Sort the hands in-place by strength.
+    // 1. Determine the type of each hand.
+    // 2. Sort the hands by strength.
     // 3. Compute the total score.
-    TArray<Hand> hands = {};
-    s32 offset = 0;
-    while (offset < input.count)
-    {
-        Hand hand = {};
-        hand.cards = &input[offset];
-        input[offset + 5] = '\0';
-        offset += 6; // Iterate past the hand (5 chars and then a space).
-        hand.bid = ParseNumber(input.ptr, &offset);
-        offset += 1; // Iterate past the newline.
-        hands.Append(hand);
-    }
+    Span<Hand> hands = scratch->PushCopy(input.hands.begin(), input.hands.Length());
 
     TArray<char> buckets = TArray<char>();
-    for (Hand& hand : hands) hand.type = GetHandTypePartOne(input, hand, buckets);
+    for (Hand& hand : hands) hand.type = GetHandTypePartOne(hand, buckets);
 
-    qsort((void*)&hands[0], hands.Length(), sizeof(Hand), HandComparatorPartOne);
+    qsort((void*)hands.ptr, hands.count, sizeof(Hand), HandComparatorPartOne);
 
     s64 total_score = 0;
-    for (s32 i = 0; i < hands.Length(); ++i) total_score += (hands[i].bid * (i + 1));
+    for (s64 i = 0; i < hands.count; ++i) total_score += (hands[i].bid * (i + 1));
     return total_score;
 }
 
-static s64 DoPartTwo(Span<char> input)
+static s64 DoPartTwo(const ParsedInput& input, Arena* scratch)
 {
     // General strategy: Same as part one, but with slightly different rules for hand types
     // and strengths.
-    TArray<Hand> hands = {};
-
-    s32 offset = 0;
-    while (offset < input.count)
-    {
-        Hand hand = {};
-        hand.cards = &input[offset];
-        input[offset + 5] = '\0';
-        offset += 6; // Iterate past the hand (5 chars and then a space).
-        hand.bid = ParseNumber(input.ptr, &offset);
-        offset += 1; // Iterate past the newline.
-        hands.Append(hand);
-    }
+    Span<Hand> hands = scratch->PushCopy(input.hands.begin(), input.hands.Length());
 
     TArray<char> buckets = TArray<char>();
-    for (Hand& hand : hands) hand.type = GetHandTypePartTwo(input, hand, buckets);
+    for (Hand& hand : hands) hand.type = GetHandTypePartTwo(hand, buckets);
 
-    qsort((void*)&hands[0], hands.Length(), sizeof(Hand), HandComparatorPartTwo);
+    qsort((void*)hands.ptr, hands.count, sizeof(Hand), HandComparatorPartTwo);
 
     s64 total_score = 0;
-    for (s32 i = 0; i < hands.Length(); ++i) total_score += (hands[i].bid * (i + 1));
+    for (s64 i = 0; i < hands.count; ++i) total_score += (hands[i].bid * (i + 1));
     return total_score;
 }
 
+typedef s64 PartFunction(const ParsedInput& input, Arena* scratch);
+
+struct PartRun
+{
+    PartFunction* function;
+    const ParsedInput* input;
+    s64 result;
+    u64 us;
+    Arena scratch; // Each part gets its own, so they don't need to share an allocator when running concurrently.
+};
+
+// Runs and times one part. Takes a void* so that it can also be a thread's entry point.
+static void RunPart(void* data)
+{
+    PartRun* run = (PartRun*)data;
+    Platform::Timer timer = {};
+    Platform::TimerStart(&timer);
+    run->result = run->function(*run->input, &run->scratch);
+    run->us = Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer));
+}
+
 int main(int argc, char* argv[])
 {
-    // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
-    Span<u8> input_file = Platform::ReadFileToBuffer(path);
+    // Arguments are the input path (optional), and --concurrent to run the two parts at the same time.
+    IString path = DEFAULT_INPUT_PATH;
+    bool concurrent = false;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        if (arg == "--concurrent") concurrent = true;
+        else path = arg;
+    }
+
+    // Map the input file. Parsing and both parts all read from the one copy.
+    Span<const u8> input_file = Platform::MapFile(path);
 
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s64 part1 = DoPartOne({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    // Parse once, for both parts.
+    ParsedInput parsed = Parse({(const char*)input_file.ptr, input_file.count});
+    u64 parse_counts = Platform::TimerMeasureCounts(&timer);
 
-    s64 part2 = DoPartTwo({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+    // Do the actual work. Concurrently, part two gets a thread of its own while part one runs on this one.
+    PartRun part1 = {DoPartOne, &parsed};
+    PartRun part2 = {DoPartTwo, &parsed};
+    if (concurrent)
+    {
+        Platform::Thread thread = Platform::StartThread(RunPart, &part2);
+        AssertCustom(thread.handle, "Failed to start a thread for part two.");
+        RunPart(&part1);
+        Platform::JoinThread(&thread);
+    }
+    else
+    {
+        RunPart(&part1);
+        RunPart(&part2);
+    }
+    u64 total_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+    u64 parse_us = Platform::TimerCountsToMicroseconds(&timer, parse_counts);
+    u64 total_us = Platform::TimerCountsToMicroseconds(&timer, total_counts);
 
     // Print results.
-    PrintF("Part 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
-    // Free the input file and exit.
-    free(input_file.ptr);
+    PrintF("Parsed in %lldus\nPart 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\nTotal: %lldus%s\n",
+           parse_us, part1.result, part1.us, part2.result, part2.us, total_us, concurrent ? " (parts ran concurrently)" : "");
+    // Unmap the input file and exit.
+    Platform::UnmapFile(input_file);
     return 0;
 }
-
-
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "EngineCore.h"
+
+/**
+ * Bump allocator for scratch memory. Allocations are just a pointer increment within the current block,
+ * and nothing is freed individually: Reset() rewinds the whole arena at once (keeping its blocks for
+ * reuse), and Free() gives the blocks back. Memory is not zeroed.
+ *
+ * The runner gives each part its own arena, so parts can make scratch copies of the (read-only) parsed
+ * input without touching the allocator on the hot path, and without stepping on each other when they run
+ * at the same time. Blocks never move, so pointers stay valid until the next Reset() or Free().
+ */
+struct Arena
+{
+    // Size of each block. Allocations bigger than this get a block to themselves.
+    constexpr static s64 BlockSize = KB(256);
+
+    Arena() = default;
+    Arena(const Arena& other) = delete;
+    Arena& operator=(const Arena& other) = delete;
+    ~Arena() {Free();}
+
+    void* Allocate(s64 size, s64 alignment = 16); // Alignment must be a power of two.
+
+    template <typename T> Span<T> PushArray(s64 count)
+    {
+        return {(T*)Allocate(count * sizeof(T), alignof(T)), count};
+    }
+
+    // Copies count elements from source. Only for types that are fine to memcpy.
+    template <typename T> Span<T> PushCopy(const T* source, s64 count)
+    {
+        Span<T> result = PushArray<T>(count);
+        if (count) memcpy(result.ptr, source, result.ByteSize());
+        return result;
+    }
+
+    void Reset();
+    void Free();
+
+    s64 BytesUsed() const {return used;}
+
+    private:
+    struct Block
+    {
+        char* ptr;
+        s64 size;
+    };
+
+    TArray<Block> blocks;
+    s32 current; // Index of the block we're allocating from.
+    s64 cursor; // Offset of the next free byte in the current block.
+    s64 used;
+};
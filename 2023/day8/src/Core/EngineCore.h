@@ -60,6 +60,15 @@ StrPrintF(OUTPUT_BUFFER, OUTPUT_BUFFER_SIZE, format, __VA_ARGS__); \
 ErrPrint(OUTPUT_BUFFER);                                           \
 }
 
+// The print and assert macros call into the platform layer. Declare those functions here, so that Core
+// code (including templates, which need the names at definition time) can use them without Platform.h.
+namespace Platform
+{
+    void PrintMessage(const char* message);
+    void PrintError(const char* message);
+    bool ShowAssertDialog(const char* message);
+};
+
 // Assert macros.
 #ifndef NDEBUG
 #define Assert(x)                                                                                                      \
@@ -94,4 +103,7 @@ if (Platform::ShowAssertDialog(OUTPUT_BUFFER)) __debugbreak();
 
 
 #include "Span.h"
-#include "stb_ds.h"
\ No newline at end of file
+#include "StringPool.h"
+#include "Records.h"
+#include "stb_ds.h"
+#include "Arena.h"
\ No newline at end of file
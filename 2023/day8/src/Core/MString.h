@@ -15,6 +15,8 @@
 // negative values anywhere, and the asserts/bounds checks do still check for incorrect negative values).
 typedef size_t MSTRING_SIZE_T;
 
+#include <stdint.h> // For the uint64_t returned by Hash().
+
 // If you #define your own MSTRING_MALLOC, MSTRING_REALLOC, and MSTRING_FREE,
 // then we don't need to #include <stdlib.h>, and will use your versions instead.
 
@@ -24,6 +26,9 @@ typedef size_t MSTRING_SIZE_T;
 // If you #define MSTRING_ASSERT, then we don't need to #include <assert.h>.
 // You can also define it to nothing if you don't want the asserts at all.
 
+// Comparisons and searches use SSE2 whenever the target has it (always true on x64). If you
+// #define MSTRING_NO_SIMD, we fall back to plain scalar loops instead.
+
 // An immutable string. Can be a wrapper for a const char* and length, or for other data.
 // This does not own the string memory, and we don't do any checks for validity, this
 // is just a convenience wrapper to simplify passing strings around.
@@ -47,6 +52,22 @@ struct IString
     constexpr const char* begin() const {return Ptr();}
     constexpr const char* end() const {return Ptr() + Length();}
 
+    // Returns a view of count characters starting at first. No bounds checks, same as everything else here.
+    constexpr IString SubString(MSTRING_SIZE_T first, MSTRING_SIZE_T count) const {return IString(Ptr() + first, count);}
+
+    // Searching. These return the index of the first match at or after start, or NotFound.
+    constexpr static MSTRING_SIZE_T NotFound = (MSTRING_SIZE_T)-1;
+    MSTRING_SIZE_T FindChar(char c, MSTRING_SIZE_T start = 0) const;
+    MSTRING_SIZE_T Find(IString needle, MSTRING_SIZE_T start = 0) const;
+
+    // Returns everything before the first delimiter, and writes everything after it to remainder.
+    // If there is no delimiter, returns the whole string and leaves the remainder empty. Tokenizing
+    // looks like: while (rest.Length()) {IString token = rest.Split(',', &rest); ...}
+    IString Split(char delimiter, IString* remainder) const;
+
+    // Fast non-cryptographic hash of the string contents. Stable for a given build, but don't persist it.
+    uint64_t Hash() const;
+
     // Comparison operators. Comparison with MString is implemented inside of MString.
     inline friend bool operator==(IString lhs, IString rhs);
     inline friend bool operator==(IString lhs, const char* rhs);
@@ -104,8 +125,12 @@ struct MString
     constexpr const char* begin() const {return Ptr();}
     constexpr const char* end() const {return Ptr() + Length();}
 
-    // Comparison operators.
-    // @Speed(Frog): These could be faster if they didn't call memcmp(), we don't care about lexicographic ordering.
+    // Searching and hashing, forwarded to IString.
+    inline MSTRING_SIZE_T FindChar(char c, MSTRING_SIZE_T start = 0) const {return IString(*this).FindChar(c, start);}
+    inline MSTRING_SIZE_T Find(IString needle, MSTRING_SIZE_T start = 0) const {return IString(*this).Find(needle, start);}
+    inline uint64_t Hash() const {return IString(*this).Hash();}
+
+    // Comparison operators. These only test for equality, we don't care about lexicographic ordering.
     inline friend bool operator==(const MString& lhs, const MString& rhs);
     inline friend bool operator==(const MString& lhs, IString rhs);
     inline friend bool operator==(const MString& lhs, const char* rhs);
@@ -225,17 +250,212 @@ struct MString
 #define MSTRING_STRLEN(str) strlen(str)
 #endif
 
-// Misc one-liners that have to be in the implementation section because they call
-// strlen() or memcmp(), which the caller of this library might re-define.
-bool operator==(IString lhs, IString rhs)     {return (lhs.Length() == rhs.Length() && MSTRING_MEMCMP(lhs.Ptr(), rhs.Ptr(), lhs.Length()) == 0);}
-bool operator==(IString lhs, const char* rhs) {return (lhs.Length() == (MSTRING_SIZE_T)MSTRING_STRLEN(rhs) && MSTRING_MEMCMP(lhs.Ptr(), rhs, lhs.Length()) == 0);}
-bool operator==(const char* lhs, IString rhs) {return ((MSTRING_SIZE_T)MSTRING_STRLEN(lhs) == rhs.Length() && MSTRING_MEMCMP(lhs, rhs.Ptr(), rhs.Length()) == 0);}
-
-bool operator==(const MString& lhs, const MString& rhs) {return (lhs.Length() == rhs.Length() && MSTRING_MEMCMP(lhs.Ptr(), rhs.Ptr(), lhs.Length()) == 0);}
-bool operator==(const MString& lhs, IString rhs)        {return (lhs.Length() == rhs.Length() && MSTRING_MEMCMP(lhs.Ptr(), rhs.Ptr(), lhs.Length()) == 0);}
-bool operator==(const MString& lhs, const char* rhs)    {return (lhs.Length() == (MSTRING_SIZE_T)MSTRING_STRLEN(rhs) && MSTRING_MEMCMP(lhs.Ptr(), rhs, lhs.Length()) == 0);}
-bool operator==(IString lhs, const MString& rhs)        {return (lhs.Length() == rhs.Length() && MSTRING_MEMCMP(lhs.Ptr(), rhs.Ptr(), lhs.Length()) == 0);}
-bool operator==(const char* lhs, const MString& rhs)    {return ((MSTRING_SIZE_T)MSTRING_STRLEN(lhs) == rhs.Length() && MSTRING_MEMCMP(lhs, rhs.Ptr(), rhs.Length()) == 0);}
+#if !defined MSTRING_NO_SIMD && (defined _M_X64 || defined __SSE2__ || (defined _M_IX86_FP && _M_IX86_FP >= 2))
+#define MSTRING_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace MStringInternal
+{
+#ifdef _MSC_VER
+static inline unsigned CountTrailingZeros(unsigned value) {unsigned long index; _BitScanForward(&index, value); return (unsigned)index;}
+#else
+static inline unsigned CountTrailingZeros(unsigned value) {return (unsigned)__builtin_ctz(value);}
+#endif
+
+#ifdef MSTRING_SSE2
+// Loads are never allowed to cross into a page we weren't asked to read, since it might not be mapped.
+// Reading past the end of a string is fine as long as we stay on the same page.
+constexpr uintptr_t PageSize = 4096;
+static inline bool CanLoad16(const char* ptr) {return ((uintptr_t)ptr & (PageSize - 1)) <= PageSize - 16;}
+
+// Loads min(count, 16) bytes from ptr and zero-fills the rest of the vector.
+static inline __m128i LoadPartial(const char* ptr, MSTRING_SIZE_T count)
+{
+    if (count >= 16) return _mm_loadu_si128((const __m128i*)ptr);
+    if (count == 0) return _mm_setzero_si128(); // ptr might be one past the end of a mapped page.
+    if (CanLoad16(ptr))
+    {
+        __m128i keep = _mm_cmplt_epi8(_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm_set1_epi8((char)count));
+        return _mm_and_si128(_mm_loadu_si128((const __m128i*)ptr), keep);
+    }
+    char buffer[16] = {};
+    for (MSTRING_SIZE_T i = 0; i < count; ++i) buffer[i] = ptr[i];
+    return _mm_loadu_si128((const __m128i*)buffer);
+}
+
+// Bitmask of the bytes which are equal in a and b.
+static inline unsigned EqualMask(__m128i a, __m128i b) {return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));}
+#endif
+
+// Equality of two buffers of the same length. Short (SSO-sized) strings take one or two compares.
+static bool BytesEqual(const char* lhs, const char* rhs, MSTRING_SIZE_T length)
+{
+#ifdef MSTRING_SSE2
+    if (length < 16) return EqualMask(LoadPartial(lhs, length), LoadPartial(rhs, length)) == 0xffff;
+    MSTRING_SIZE_T i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        if (EqualMask(_mm_loadu_si128((const __m128i*)(lhs + i)), _mm_loadu_si128((const __m128i*)(rhs + i))) != 0xffff) return false;
+    }
+    // Compare the tail with one overlapping load instead of a partial one.
+    if (i < length)
+    {
+        i = length - 16;
+        return EqualMask(_mm_loadu_si128((const __m128i*)(lhs + i)), _mm_loadu_si128((const __m128i*)(rhs + i))) == 0xffff;
+    }
+    return true;
+#else
+    return MSTRING_MEMCMP(lhs, rhs, length) == 0;
+#endif
+}
+
+// Equality of a buffer with a null-terminated string, without calling strlen() on it first.
+// We stop reading the C string as soon as we hit either its terminator or the end of the buffer.
+static bool BytesEqualCString(const char* lhs, MSTRING_SIZE_T length, const char* cstr)
+{
+#ifdef MSTRING_SSE2
+    for (MSTRING_SIZE_T i = 0;; i += 16)
+    {
+        const char* rhs = cstr + i;
+        __m128i r;
+        if (CanLoad16(rhs)) r = _mm_loadu_si128((const __m128i*)rhs);
+        else
+        {
+            // Near a page boundary, copy up to the terminator so we never read past it.
+            char buffer[16] = {};
+            for (int j = 0; j < 16 && rhs[j]; ++j) buffer[j] = rhs[j];
+            r = _mm_loadu_si128((const __m128i*)buffer);
+        }
+
+        MSTRING_SIZE_T remaining = length - i;
+        unsigned different = ~EqualMask(LoadPartial(lhs + i, remaining), r) & 0xffff;
+        unsigned terminators = EqualMask(r, _mm_setzero_si128());
+        if (remaining >= 16)
+        {
+            if (different | terminators) return false;
+            continue;
+        }
+
+        // Everything before the end of lhs must match and be non-zero, and the C string must end right there.
+        unsigned valid = (1u << remaining) - 1;
+        return !((different | terminators) & valid) && ((terminators >> remaining) & 1);
+    }
+#else
+    return (length == (MSTRING_SIZE_T)MSTRING_STRLEN(cstr) && MSTRING_MEMCMP(lhs, cstr, length) == 0);
+#endif
+}
+} // namespace MStringInternal
+
+bool operator==(IString lhs, IString rhs)     {return (lhs.Length() == rhs.Length() && MStringInternal::BytesEqual(lhs.Ptr(), rhs.Ptr(), lhs.Length()));}
+bool operator==(IString lhs, const char* rhs) {return MStringInternal::BytesEqualCString(lhs.Ptr(), lhs.Length(), rhs);}
+bool operator==(const char* lhs, IString rhs) {return MStringInternal::BytesEqualCString(rhs.Ptr(), rhs.Length(), lhs);}
+
+bool operator==(const MString& lhs, const MString& rhs) {return (lhs.Length() == rhs.Length() && MStringInternal::BytesEqual(lhs.Ptr(), rhs.Ptr(), lhs.Length()));}
+bool operator==(const MString& lhs, IString rhs)        {return (lhs.Length() == rhs.Length() && MStringInternal::BytesEqual(lhs.Ptr(), rhs.Ptr(), lhs.Length()));}
+bool operator==(const MString& lhs, const char* rhs)    {return MStringInternal::BytesEqualCString(lhs.Ptr(), lhs.Length(), rhs);}
+bool operator==(IString lhs, const MString& rhs)        {return (lhs.Length() == rhs.Length() && MStringInternal::BytesEqual(lhs.Ptr(), rhs.Ptr(), lhs.Length()));}
+bool operator==(const char* lhs, const MString& rhs)    {return MStringInternal::BytesEqualCString(rhs.Ptr(), rhs.Length(), lhs);}
+
+MSTRING_SIZE_T IString::FindChar(char c, MSTRING_SIZE_T start) const
+{
+    MSTRING_SIZE_T i = start;
+#ifdef MSTRING_SSE2
+    __m128i needle = _mm_set1_epi8(c);
+    for (; i + 16 <= length; i += 16)
+    {
+        unsigned mask = MStringInternal::EqualMask(_mm_loadu_si128((const __m128i*)(ptr + i)), needle);
+        if (mask) return i + MStringInternal::CountTrailingZeros(mask);
+    }
+    if (i < length)
+    {
+        // The partial load zero-fills, so mask off anything past the end in case we're looking for '\0'.
+        unsigned mask = MStringInternal::EqualMask(MStringInternal::LoadPartial(ptr + i, length - i), needle);
+        mask &= (1u << (length - i)) - 1;
+        if (mask) return i + MStringInternal::CountTrailingZeros(mask);
+    }
+#else
+    for (; i < length; ++i) if (ptr[i] == c) return i;
+#endif
+    return NotFound;
+}
+
+MSTRING_SIZE_T IString::Find(IString needle, MSTRING_SIZE_T start) const
+{
+    MSTRING_SIZE_T count = needle.Length();
+    if (start > length || count > length - start) return NotFound;
+    if (count == 0) return start;
+    if (count == 1) return FindChar(needle[0], start);
+
+    MSTRING_SIZE_T i = start;
+#ifdef MSTRING_SSE2
+    // Only do a full compare where both the first and the last characters of the needle match.
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[count - 1]);
+    for (; i + count - 1 + 16 <= length; i += 16)
+    {
+        unsigned mask = MStringInternal::EqualMask(_mm_loadu_si128((const __m128i*)(ptr + i)), first);
+        mask &= MStringInternal::EqualMask(_mm_loadu_si128((const __m128i*)(ptr + i + count - 1)), last);
+        while (mask)
+        {
+            MSTRING_SIZE_T candidate = i + MStringInternal::CountTrailingZeros(mask);
+            if (MStringInternal::BytesEqual(ptr + candidate + 1, needle.Ptr() + 1, count - 2)) return candidate;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + count <= length; ++i)
+    {
+        if (ptr[i] == needle[0] && MStringInternal::BytesEqual(ptr + i + 1, needle.Ptr() + 1, count - 1)) return i;
+    }
+    return NotFound;
+}
+
+IString IString::Split(char delimiter, IString* remainder) const
+{
+    // Careful, remainder is allowed to point at this string, so build the result before writing to it.
+    MSTRING_SIZE_T index = FindChar(delimiter);
+    IString result = (index == NotFound) ? *this : IString(ptr, index);
+    if (remainder) *remainder = (index == NotFound) ? IString(ptr + length, 0) : IString(ptr + index + 1, length - index - 1);
+    return result;
+}
+
+uint64_t IString::Hash() const
+{
+    // Multiply-xorshift over 8 bytes at a time, with a murmur3-style finalizer. Short strings
+    // are one or two rounds. Good enough distribution for hash tables, not for anything adversarial.
+    const uint64_t multiplier = 0x9fb21c651e98df25ull;
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ ((uint64_t)length * multiplier);
+    const char* p = ptr;
+    MSTRING_SIZE_T remaining = length;
+    while (remaining >= 8)
+    {
+        uint64_t word;
+        MSTRING_MEMCPY(&word, p, 8);
+        word *= multiplier;
+        word ^= word >> 32;
+        hash = (hash ^ word) * multiplier;
+        p += 8;
+        remaining -= 8;
+    }
+    if (remaining)
+    {
+        uint64_t word = 0;
+        MSTRING_MEMCPY(&word, p, remaining);
+        word *= multiplier;
+        word ^= word >> 32;
+        hash = (hash ^ word) * multiplier;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
 
 IString::IString(const char* ptr) : ptr(ptr), length((MSTRING_SIZE_T)MSTRING_STRLEN(ptr)) {}
 MString::MString(const char* ptr) : MString(ptr, (MSTRING_SIZE_T)MSTRING_STRLEN(ptr)) {}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "EngineCore.h"
+
+#if defined __AVX2__
+#define RECORDS_AVX2
+#include <immintrin.h>
+#elif defined _M_X64 || defined __SSE2__
+#define RECORDS_SSE2
+#include <emmintrin.h>
+#endif
+
+// Decoding for inputs made of fixed-width records, like day 8's "AAA = (BBB, CCC)" lines. The layout is
+// given at compile time, and each field comes out as its own column (structure of arrays), so the
+// decode is a strided gather with no per-byte work at all:
+//
+// using NodeLayout = RecordLayout<17, RecordField<0, 3>, RecordField<7, 3>, RecordField<12, 3>>;
+// TArray<u32> keys = {}, lefts = {}, rights = {};
+// s64 count = NodeLayout::Extract(input, {&keys, &lefts, &rights});
+//
+// Fields are up to 4 bytes, packed into a u32 in memory order (so on x86, the bytes of the u32 are the
+// characters of the field, and it can be used directly as a key or viewed as a string). Records are
+// gathered 8 at a time with AVX2 when the build allows it (/arch:AVX2), and 4 at a time with SSE2 otherwise.
+
+// Width bytes, starting Offset bytes into each record.
+template <s64 Offset, s64 Width> struct RecordField
+{
+    static_assert(Offset >= 0 && Width >= 1 && Width <= 4, "Record fields must be between 1 and 4 bytes wide.");
+    static constexpr s64 offset = Offset;
+    static constexpr s64 width = Width;
+    static constexpr u32 mask = (Width == 4) ? 0xffffffffu : ((1u << (Width * 8)) - 1);
+};
+
+namespace RecordsInternal
+{
+template <typename... Values> constexpr s64 Max(Values... values)
+{
+    s64 result = 0;
+    ((result = (values > result) ? values : result), ...);
+    return result;
+}
+
+inline u32 Load32(const char* ptr)
+{
+    u32 result;
+    memcpy(&result, ptr, sizeof(result));
+    return result;
+}
+
+#if defined RECORDS_AVX2
+constexpr s64 Lanes = 8;
+template <s64 Stride, typename Field> inline void GatherField(const char* records, u32* out)
+{
+    __m256i indices = _mm256_setr_epi32(0, Stride, 2 * Stride, 3 * Stride, 4 * Stride, 5 * Stride, 6 * Stride, 7 * Stride);
+    __m256i values = _mm256_i32gather_epi32((const int*)(records + Field::offset), indices, 1);
+    values = _mm256_and_si256(values, _mm256_set1_epi32((int)Field::mask));
+    _mm256_storeu_si256((__m256i*)out, values);
+}
+#elif defined RECORDS_SSE2
+constexpr s64 Lanes = 4;
+template <s64 Stride, typename Field> inline void GatherField(const char* records, u32* out)
+{
+    const char* ptr = records + Field::offset;
+    __m128i values = _mm_setr_epi32((int)Load32(ptr), (int)Load32(ptr + Stride), (int)Load32(ptr + 2 * Stride), (int)Load32(ptr + 3 * Stride));
+    values = _mm_and_si128(values, _mm_set1_epi32((int)Field::mask));
+    _mm_storeu_si128((__m128i*)out, values);
+}
+#else
+constexpr s64 Lanes = 1;
+template <s64 Stride, typename Field> inline void GatherField(const char* records, u32* out)
+{
+    *out = Load32(records + Field::offset) & Field::mask;
+}
+#endif
+
+// Exact-width load, for the last few records where reading a whole u32 could run off the end of the input.
+template <typename Field> inline u32 LoadFieldExact(const char* record)
+{
+    u32 result = 0;
+    memcpy(&result, record + Field::offset, Field::width);
+    return result;
+}
+} // namespace RecordsInternal
+
+template <s64 Stride, typename... Fields> struct RecordLayout
+{
+    static constexpr s64 field_count = sizeof...(Fields);
+    static constexpr s64 record_size = RecordsInternal::Max((Fields::offset + Fields::width)...); // Bytes a record needs to be complete.
+    static constexpr s64 load_size = RecordsInternal::Max((Fields::offset + 4)...); // Bytes a record needs for full width loads.
+    static_assert(field_count > 0, "A record layout needs at least one field.");
+    static_assert(record_size <= Stride, "Record fields must fit within the stride.");
+
+    // Number of complete records in the input. The last one doesn't need its trailing bytes (like a newline).
+    static s64 Count(IString input)
+    {
+        s64 length = (s64)input.Length();
+        return (length >= record_size) ? (length - record_size) / Stride + 1 : 0;
+    }
+
+    // Decodes every record, replacing the contents of each column. Returns the record count.
+    static s64 Extract(IString input, TArray<u32>* const (&columns)[field_count])
+    {
+        s64 count = Count(input);
+        for (TArray<u32>* column : columns) column->SetLength((tarray_int)count);
+        if (count == 0) return 0;
+
+        u32* out[field_count];
+        for (s64 i = 0; i < field_count; ++i) out[i] = &(*columns[i])[0];
+
+        // Full width loads are fine as long as the last record in the batch has load_size bytes left.
+        s64 length = (s64)input.Length();
+        s64 vector_count = (length >= load_size) ? (length - load_size) / Stride + 1 : 0;
+        if (vector_count > count) vector_count = count;
+
+        s64 record = 0;
+        for (; record + RecordsInternal::Lanes <= vector_count; record += RecordsInternal::Lanes)
+        {
+            const char* records = input.Ptr() + record * Stride;
+            s64 column = 0;
+            (RecordsInternal::GatherField<Stride, Fields>(records, out[column++] + record), ...);
+        }
+        for (; record < count; ++record)
+        {
+            const char* ptr = input.Ptr() + record * Stride;
+            s64 column = 0;
+            ((out[column++][record] = RecordsInternal::LoadFieldExact<Fields>(ptr)), ...);
+        }
+        return count;
+    }
+};
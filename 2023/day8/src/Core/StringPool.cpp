@@ -0,0 +1,96 @@
+#include "Core/StringPool.h"
+#include "Platform/Platform.h"
+
+StringHandle StringPool::Intern(IString str)
+{
+    Assert(str.Length() < U32_MAX);
+    // Keep the table at most half full, so probe sequences stay short.
+    if ((entries.Length() + 1) * 2 > slots.Length()) Grow();
+
+    u64 hash = str.Hash();
+    u32 slot = FindSlot(str, hash);
+    if (slots[slot]) return {slots[slot] - 1};
+
+    Entry entry = {Store(str), hash, (u32)str.Length()};
+    slots[slot] = (u32)entries.Append(entry); // Append returns the new length, which is the handle + 1.
+    return {slots[slot] - 1};
+}
+
+bool StringPool::Find(IString str, StringHandle* out_handle) const
+{
+    if (!slots.Length()) return false;
+    u32 slot = FindSlot(str, str.Hash());
+    if (!slots[slot]) return false;
+    if (out_handle) *out_handle = {slots[slot] - 1};
+    return true;
+}
+
+IString StringPool::Get(StringHandle handle) const
+{
+    const Entry& entry = entries[handle.index];
+    return IString(entry.ptr, entry.length);
+}
+
+u64 StringPool::Hash(StringHandle handle) const
+{
+    return entries[handle.index].hash;
+}
+
+void StringPool::Free()
+{
+    for (char* block : blocks) free(block);
+    blocks.Free();
+    entries.Free();
+    slots.Free();
+    block_cursor = nullptr;
+    block_remaining = 0;
+}
+
+u32 StringPool::FindSlot(IString str, u64 hash) const
+{
+    // Linear probing. We check the stored hash first, so we only touch string memory on a likely match.
+    u32 mask = (u32)slots.Length() - 1;
+    for (u32 slot = (u32)hash & mask;; slot = (slot + 1) & mask)
+    {
+        u32 value = slots[slot];
+        if (!value) return slot;
+        const Entry& entry = entries[value - 1];
+        if (entry.hash == hash && IString(entry.ptr, entry.length) == str) return slot;
+    }
+}
+
+void StringPool::Grow()
+{
+    s32 capacity = (slots.Length()) ? slots.Length() * 2 : 64;
+    slots.Free();
+    slots.SetLength(capacity); // New capacity is zeroed, so every slot starts out empty.
+
+    // Re-insert everything. Every entry is distinct, so we only need to look for empty slots.
+    u32 mask = (u32)capacity - 1;
+    for (s32 i = 0; i < entries.Length(); ++i)
+    {
+        u32 slot = (u32)entries[i].hash & mask;
+        while (slots[slot]) slot = (slot + 1) & mask;
+        slots[slot] = (u32)i + 1;
+    }
+}
+
+const char* StringPool::Store(IString str)
+{
+    s64 size = (s64)str.Length() + 1; // Keep a null terminator, so Get() works with C APIs too.
+    if (size > block_remaining)
+    {
+        s64 block_size = (size > BlockSize) ? size : BlockSize;
+        char* block = (char*)malloc(block_size);
+        blocks.Append(block);
+        block_cursor = block;
+        block_remaining = block_size;
+    }
+
+    char* result = block_cursor;
+    memcpy(result, str.Ptr(), str.Length());
+    result[str.Length()] = '\0';
+    block_cursor += size;
+    block_remaining -= size;
+    return result;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "EngineCore.h"
+
+/**
+ * Interns strings into one arena and hands back 32-bit handles. Two handles from the same pool are
+ * equal exactly when their strings are equal, so once something is interned, comparing it is an
+ * integer compare and hashing it is a lookup of the hash we computed on the way in.
+ *
+ * Handles are dense and assigned in insertion order (0, 1, 2, ...), so they can be used directly as
+ * indices into your own arrays. That is the main point: symbolic inputs like node names or labels
+ * turn into small integers without any per-day bit packing.
+ *
+ * String data is copied into fixed-size blocks that never move, so the IStrings returned by Get()
+ * stay valid until the pool is freed. Interned strings are null-terminated.
+ */
+struct StringHandle
+{
+    u32 index;
+
+    inline friend bool operator==(StringHandle lhs, StringHandle rhs) {return lhs.index == rhs.index;}
+    inline friend bool operator!=(StringHandle lhs, StringHandle rhs) {return lhs.index != rhs.index;}
+};
+
+struct StringPool
+{
+    // Size of each arena block. Strings longer than this get a block to themselves.
+    constexpr static s64 BlockSize = KB(64);
+
+    StringPool() = default;
+    StringPool(const StringPool& other) = delete;
+    StringPool& operator=(const StringPool& other) = delete;
+    ~StringPool() {Free();}
+
+    // Returns the handle for str, copying it into the pool if we haven't seen it before.
+    StringHandle Intern(IString str);
+
+    // Looks up str without inserting it. Returns false if it was never interned.
+    bool Find(IString str, StringHandle* out_handle) const;
+
+    // Reverse lookup, and the memoized hash (the same value IString::Hash() would give you).
+    IString Get(StringHandle handle) const;
+    u64 Hash(StringHandle handle) const;
+
+    // Number of distinct strings, which is also one past the largest handle.
+    s32 Count() const {return entries.Length();}
+
+    void Free();
+
+    private:
+    struct Entry
+    {
+        const char* ptr;
+        u64 hash;
+        u32 length;
+    };
+
+    u32 FindSlot(IString str, u64 hash) const; // Slot holding str, or the empty slot where it belongs.
+    void Grow();
+    const char* Store(IString str);
+
+    TArray<Entry> entries; // Indexed by handle.
+    TArray<u32> slots; // Open-addressed table of handle + 1, where 0 means empty. Always a power of two in size.
+    TArray<char*> blocks;
+    char* block_cursor;
+    s64 block_remaining;
+};
@@ -4,65 +4,83 @@
 
 #define DEFAULT_INPUT_PATH "input.txt"
 
-#define ENCODE_KEY(a,b,c) ((u32)(((a)<<16) | ((b)<<8) | (c)))
-#define ENCODE_KEY2(a,b,c) ((u16)((((a) - 'A') << 10) | (((b) - 'A') << 5) | ((c) - 'A')))
-#define ENCODE_NODE2(left, right) ((u32)(((left) << 16) | (right)))
-
-#define DECODE_LEFT(node) ((u16)((node) >> 16))
-#define DECODE_RIGHT(node) ((u16)((node) & 0xffff))
-
-#define IS_START2(key) ((bool)(((key) & 0x1f) == 0))
-#define IS_END2(key) ((bool)(((key) & 0x1f) == 25))
-
 struct Node
 {
-    u32 left;
-    u32 right;
+    StringHandle left;
+    StringHandle right;
 };
 
-struct NodePair
+// Node names are interned, so each name is a dense index into the node table.
+struct Network
 {
-    u32 key;
-    Node value;
+    StringPool names;
+    TArray<Node> nodes; // Indexed by name handle.
 };
 
-static inline bool IsStartingNode(u32 key) {return ((key & 0xff) == 'A');}
-static inline bool IsEndingNode(u32 key) {return ((key & 0xff) == 'Z');}
-
-// static inline bool IsStartingNode2(u16 key) {return ((key & 0x1f) == ('A' - 'A'));}
-// static inline bool IsEndingNode2(u16 key) {return ((key & 0x1f) == ('Z' - 'A'));}
+// The instructions (as 0 for left and 1 for right, to make checking slightly easier) and the network.
+// This can't be copied (StringPool can't be), so Parse() fills it in rather than returning it.
+struct ParsedInput
+{
+    TArray<u8> is_right;
+    Network network;
+};
 
+// Each node is a fixed-width line like "AAA = (BBB, CCC)", 17 bytes including the newline.
+using NodeLayout = RecordLayout<17, RecordField<0, 3>, RecordField<7, 3>, RecordField<12, 3>>;
 
-static s64 DoPartOne(Span<char> input)
+// Parses the node list starting at offset.
+static void ParseNetwork(Span<const char> input, s64 offset, Network* network)
 {
-    NodePair* map = 0;
+    // Each column holds the names themselves, packed into a u32 (so the first 3 bytes are the name).
+    TArray<u32> keys = {};
+    TArray<u32> lefts = {};
+    TArray<u32> rights = {};
+    tarray_int count = (tarray_int)NodeLayout::Extract({&input[offset], (u32)(input.count - offset)}, {&keys, &lefts, &rights});
+
+    // A node can be referenced before its own line, so we can only fill in the table once every name is interned.
+    TArray<StringHandle> key_handles = TArray<StringHandle>(count);
+    TArray<Node> values = TArray<Node>(count);
+    for (tarray_int i = 0; i < count; ++i)
+    {
+        key_handles[i] = network->names.Intern({(const char*)&keys[i], 3});
+        values[i].left = network->names.Intern({(const char*)&lefts[i], 3});
+        values[i].right = network->names.Intern({(const char*)&rights[i], 3});
+    }
 
-    char* instructions = input.ptr;
+    network->nodes.SetLength(network->names.Count());
+    for (tarray_int i = 0; i < count; ++i) network->nodes[key_handles[i].index] = values[i];
+}
 
-    s32 offset = 0;
+static void Parse(Span<const char> input, ParsedInput* parsed)
+{
+    s64 offset = 0;
     while (input[offset] != '\n') ++offset;
-    s32 instructions_length = offset;
-    input[offset] = '\0';
+    s64 instructions_length = offset;
     offset += 2;
 
-    while (offset < input.count)
-    {
-        u32 key = ENCODE_KEY(input[offset], input[offset + 1], input[offset + 2]);
-        Node value = {ENCODE_KEY(input[offset + 7], input[offset + 8], input[offset + 9]), ENCODE_KEY(input[offset + 12], input[offset + 13], input[offset + 14])};
-        //PrintF("Key: %c%c%c, IsStart: %d, IsEnd: %d\n", input[offset], input[offset + 1], input[offset + 2], IsStartingNode(key), IsEndingNode(key));
-        offset += 17;
-        hmput(map, key, value);
-    }
+    parsed->is_right.SetLength((tarray_int)instructions_length);
+    for (s64 i = 0; i < instructions_length; ++i) parsed->is_right[(tarray_int)i] = (input[i] == 'R');
 
-    s64 step_count = 0;
+    ParseNetwork(input, offset, &parsed->network);
+}
+
+static s64 DoPartOne(const ParsedInput& input, Arena* scratch)
+{
+    const Network& network = input.network;
+    const TArray<u8>& is_right = input.is_right;
+
+    StringHandle current_node = {};
+    StringHandle last_node = {};
+    if (!network.names.Find("AAA", &current_node) || !network.names.Find("ZZZ", &last_node)) return 0;
 
+    s64 step_count = 0;
     s32 instructions_offset = 0;
-    u32 current_node = ENCODE_KEY('A', 'A', 'A');
-    while (current_node != ENCODE_KEY('Z', 'Z', 'Z'))
+    while (current_node != last_node)
     {
-        bool is_left = (instructions[instructions_offset] == 'L');
-        instructions_offset = (instructions_offset + 1) % instructions_length;
-        current_node = (is_left) ? hmget(map, current_node).left : hmget(map, current_node).right;
+        bool is_left = !is_right[instructions_offset];
+        instructions_offset = (instructions_offset + 1) % is_right.Length();
+        const Node& node = network.nodes[current_node.index];
+        current_node = (is_left) ? node.left : node.right;
         ++step_count;
     }
 
@@ -82,49 +100,33 @@ s64 LeastCommonMultiple(s32* in, s32 count)
     return result;
 }
 
-static s64 DoPartTwo(Span<char> input)
+static s64 DoPartTwo(const ParsedInput& input, Arena* scratch)
 {
-   u32 map[1<<15];
-
-    TArray<u16> simultaneous_nodes = {};
-
-    char* instructions = input.ptr;
-
-    s32 offset = 0;
-    while (input[offset] != '\n') ++offset;
-    s32 instructions_length = offset;
-    input[offset] = '\0';
-    offset += 2;
-
-    // Replace the L and R sequence with a 0 and 1 sequence, just to make checking slightly easier.
-    for (s32 i = 0; i < instructions_length; ++i) instructions[i] = (instructions[i] == 'L') ? 0 : 1;
-
-    // Encode the map in a big lookup table. Since each letter can hold 26 values, that fits in 5 bits (where 'A' == 0 and 'Z' == 25).
-    // We pack the three letters into 15 bits of a 16 bit key, and then create a lookup table of all 32768 possible keys.
-
-    while (offset < input.count)
+    const Network& network = input.network;
+    const TArray<u8>& is_right = input.is_right;
+    s32 instructions_length = is_right.Length();
+
+    // Classify every node up front, so the walk below only deals with handles.
+    TArray<StringHandle> simultaneous_nodes = {};
+    Span<bool> is_end_node = scratch->PushArray<bool>(network.names.Count());
+    for (u32 i = 0; i < (u32)network.names.Count(); ++i)
     {
-        u16 key = ENCODE_KEY2(input[offset], input[offset + 1], input[offset + 2]);
-        u16 left = ENCODE_KEY2(input[offset + 7], input[offset + 8], input[offset + 9]);
-        u16 right = ENCODE_KEY2(input[offset + 12], input[offset + 13], input[offset + 14]);
-        map[key] = ENCODE_NODE2(left, right);
-
-        if (IS_START2(key)) simultaneous_nodes.Append(key);
-        offset += 17;
+        IString name = network.names.Get(StringHandle{i});
+        if (name[2] == 'A') simultaneous_nodes.Append(StringHandle{i});
+        is_end_node[i] = (name[2] == 'Z');
     }
 
     TArray<s32> cycle_lengths = {};
     s32 instructions_offset = 0;
 
-    for (u16 start : simultaneous_nodes)
+    for (StringHandle start : simultaneous_nodes)
     {
         s32 cycle_length = 0;
-        u16 current = start;
-        while (!IS_END2(current))
+        StringHandle current = start;
+        while (!is_end_node[current.index])
         {
-            bool is_left = (instructions[instructions_offset]);
-            u32 node = map[current];
-            current = (is_left) ? DECODE_RIGHT(node) : DECODE_LEFT(node);
+            const Node& node = network.nodes[current.index];
+            current = (is_right[instructions_offset]) ? node.right : node.left;
 
             cycle_length += 1;
             instructions_offset += 1;
@@ -136,34 +138,76 @@ static s64 DoPartTwo(Span<char> input)
     return LeastCommonMultiple(&cycle_lengths[0], cycle_lengths.Length());
 }
 
+typedef s64 PartFunction(const ParsedInput& input, Arena* scratch);
+
+struct PartRun
+{
+    PartFunction* function;
+    const ParsedInput* input;
+    s64 result;
+    u64 us;
+    Arena scratch; // Each part gets its own, so they don't need to share an allocator when running concurrently.
+};
+
+// Runs and times one part. Takes a void* so that it can also be a thread's entry point.
+static void RunPart(void* data)
+{
+    PartRun* run = (PartRun*)data;
+    Platform::Timer timer = {};
+    Platform::TimerStart(&timer);
+    run->result = run->function(*run->input, &run->scratch);
+    run->us = Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer));
+}
+
 int main(int argc, char* argv[])
 {
-    // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
-    Span<u8> input_file1 = Platform::ReadFileToBuffer(path);
-    Span<u8> input_file2 = Platform::ReadFileToBuffer(path);
+    // Arguments are the input path (optional), and --concurrent to run the two parts at the same time.
+    IString path = DEFAULT_INPUT_PATH;
+    bool concurrent = false;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        if (arg == "--concurrent") concurrent = true;
+        else path = arg;
+    }
+
+    // Map the input file. Parsing and both parts all read from the one copy.
+    Span<const u8> input_file = Platform::MapFile(path);
+
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    //s64 part1 = DoPartOne({(char*)input_file1.ptr, (u32)input_file1.count});
-    s64 part1 = 0;
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    // Parse once, for both parts.
+    ParsedInput parsed = {};
+    Parse({(const char*)input_file.ptr, input_file.count}, &parsed);
+    u64 parse_counts = Platform::TimerMeasureCounts(&timer);
 
-    s64 part2 = DoPartTwo({(char*)input_file2.ptr, (u32)input_file2.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+    // Do the actual work. Concurrently, part two gets a thread of its own while part one runs on this one.
+    PartRun part1 = {DoPartOne, &parsed};
+    PartRun part2 = {DoPartTwo, &parsed};
+    if (concurrent)
+    {
+        Platform::Thread thread = Platform::StartThread(RunPart, &part2);
+        AssertCustom(thread.handle, "Failed to start a thread for part two.");
+        RunPart(&part1);
+        Platform::JoinThread(&thread);
+    }
+    else
+    {
+        RunPart(&part1);
+        RunPart(&part2);
+    }
+    u64 total_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+    u64 parse_us = Platform::TimerCountsToMicroseconds(&timer, parse_counts);
+    u64 total_us = Platform::TimerCountsToMicroseconds(&timer, total_counts);
 
     // Print results.
-    PrintF("Part 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
-    // Free the input file and exit.
-    free(input_file1.ptr);
-    free(input_file2.ptr);
+    PrintF("Parsed in %lldus\nPart 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\nTotal: %lldus%s\n",
+           parse_us, part1.result, part1.us, part2.result, part2.us, total_us, concurrent ? " (parts ran concurrently)" : "");
+    // Unmap the input file and exit.
+    Platform::UnmapFile(input_file);
     return 0;
 }
-
-
@@ -1,4 +1,5 @@
 #include "Platform/Platform.h"
+#include <intrin.h>
 
 #ifndef LOG_BUFFER_SIZE
 #define LOG_BUFFER_SIZE 2048
@@ -159,6 +160,41 @@ bool Platform::ReadFileToBuffer(IString path, Span<u8> buffer)
 	}
 	return result;
 }
+static Platform::CpuFeatureFlags QueryCpuFeatures()
+{
+    Platform::CpuFeatureFlags result = {};
+    int info[4]; // eax, ebx, ecx, edx
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    result.sse42 = (info[2] & (1 << 20)) && (info[2] & (1 << 9)) && (info[2] & (1 << 19)); // SSE4.2, SSSE3, SSE4.1
+    result.popcnt = (info[2] & (1 << 23));
+    bool os_saves_ymm = false;
+    bool os_saves_zmm = false;
+    if (info[2] & (1 << 27)) // OSXSAVE, so we can ask which register state the OS saves.
+    {
+        u64 xcr0 = _xgetbv(0);
+        os_saves_ymm = ((xcr0 & 0x06) == 0x06);
+        os_saves_zmm = os_saves_ymm && ((xcr0 & 0xe0) == 0xe0);
+    }
+
+    if (max_leaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        result.avx2 = os_saves_ymm && (info[1] & (1 << 5));
+        result.bmi2 = (info[1] & (1 << 8));
+        result.avx512 = os_saves_zmm && (info[1] & (1 << 16)) && (info[1] & (1 << 30)); // F and BW
+    }
+    return result;
+}
+
+const Platform::CpuFeatureFlags& Platform::CpuFeatures()
+{
+    static CpuFeatureFlags features = QueryCpuFeatures();
+    return features;
+}
+
 bool Platform::IsConsoleVTEnabled()
 {
     void* std_out = Win32::GetStandardStream(STD_OUTPUT_HANDLE);
@@ -189,4 +225,202 @@ bool Platform::ShowAssertDialog(const char* message)
     int result = MessageBoxW(0, (LPCWSTR)wide_string, L"Assertion Failed!", MB_YESNO | MB_ICONERROR | MB_TOPMOST | MB_SETFOREGROUND);
     free(wide_string); // @malloc
     return (result == IDYES);
-}
\ No newline at end of file
+}
+
+Span<const u8> Platform::MapFile(IString path)
+{
+    Assert(path.Ptr() && path.Length()); // No null or empty paths allowed.
+    WCHAR stack_buffer[MAX_PATH];
+    Span<WCHAR> wide_path = {stack_buffer, MAX_PATH};
+    Win32::ConvertPath(path, &wide_path);
+    HANDLE handle = CreateFileW(wide_path.ptr, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+
+    Span<const u8> result = {};
+    if (handle != INVALID_HANDLE_VALUE)
+    {
+        // Empty files can't be mapped at all, so those just come back empty.
+        LARGE_INTEGER file_size;
+        if (GetFileSizeEx(handle, &file_size) && file_size.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingW(handle, 0, PAGE_READONLY, 0, 0, 0);
+            if (mapping)
+            {
+                // The view keeps the mapping (and the file) open, so both handles can be closed right away.
+                const u8* view = (const u8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (view) result = {view, file_size.QuadPart};
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(handle);
+    }
+    return result;
+}
+
+void Platform::UnmapFile(Span<const u8> file)
+{
+    if (file.ptr) UnmapViewOfFile(file.ptr);
+}
+
+namespace Win32 {
+struct ThreadStart
+{
+    Platform::ThreadFunction* function;
+    void* data;
+};
+
+static DWORD WINAPI ThreadEntry(void* param)
+{
+    ThreadStart start = *(ThreadStart*)param;
+    free(param); // @malloc
+    start.function(start.data);
+    return 0;
+}
+} // namespace Win32
+
+Platform::Thread Platform::StartThread(ThreadFunction* function, void* data)
+{
+    Assert(function);
+    // The start info has to outlive this call, so the new thread frees it once it has a copy.
+    Win32::ThreadStart* start = (Win32::ThreadStart*)malloc(sizeof(Win32::ThreadStart)); // @malloc
+    *start = {function, data};
+
+    Thread result = {};
+    DWORD id = 0;
+    result.handle = ::CreateThread(0, 0, Win32::ThreadEntry, start, 0, &id);
+    result.id = id;
+    if (!result.handle) free(start);
+    return result;
+}
+
+void Platform::JoinThread(Thread* thread)
+{
+    Assert(thread && thread->handle);
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    *thread = {};
+}
+
+bool Platform::SetThreadAffinity(Thread* thread, s32 core)
+{
+    Assert(thread && thread->handle);
+    Assert(core >= 0 && core < 64);
+    return SetThreadAffinityMask(thread->handle, (DWORD_PTR)1 << core) != 0;
+}
+
+bool Platform::SetCurrentThreadAffinity(s32 core)
+{
+    Assert(core >= 0 && core < 64);
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+}
+
+s32 Platform::GetCoreCount()
+{
+    return (s32)GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+}
+
+void Platform::YieldThread()
+{
+    SwitchToThread();
+}
+
+u32 Platform::CreateThreadLocal()
+{
+    DWORD slot = TlsAlloc();
+    Assert(slot != TLS_OUT_OF_INDEXES);
+    return slot;
+}
+
+void Platform::FreeThreadLocal(u32 slot)
+{
+    TlsFree(slot);
+}
+
+void Platform::SetThreadLocal(u32 slot, void* value)
+{
+    TlsSetValue(slot, value);
+}
+
+void* Platform::GetThreadLocal(u32 slot)
+{
+    return TlsGetValue(slot);
+}
+
+// The wait primitives below all park threads with WaitOnAddress, which sleeps only if the word still holds
+// the value we expect. That closes the gap between checking the state and going to sleep.
+
+void Platform::Mutex::Lock()
+{
+    u32 expected = 0;
+    if (state.CompareExchange(&expected, 1)) return;
+
+    // Contended. Mark the lock as having waiters, so whoever unlocks it knows to wake one of us.
+    if (expected != 2) expected = state.Exchange(2);
+    while (expected != 0)
+    {
+        u32 contended = 2;
+        WaitOnAddress(&state.value, &contended, sizeof(contended), INFINITE);
+        expected = state.Exchange(2);
+    }
+}
+
+bool Platform::Mutex::TryLock()
+{
+    u32 expected = 0;
+    return state.CompareExchange(&expected, 1);
+}
+
+void Platform::Mutex::Unlock()
+{
+    if (state.Exchange(0) == 2) WakeByAddressSingle((void*)&state.value);
+}
+
+void Platform::Semaphore::Wait()
+{
+    while (true)
+    {
+        s32 current = count.Load();
+        while (current > 0)
+        {
+            if (count.CompareExchange(&current, current - 1)) return;
+        }
+        WaitOnAddress(&count.value, &current, sizeof(current), INFINITE);
+    }
+}
+
+bool Platform::Semaphore::TryWait()
+{
+    s32 current = count.Load();
+    while (current > 0)
+    {
+        if (count.CompareExchange(&current, current - 1)) return true;
+    }
+    return false;
+}
+
+void Platform::Semaphore::Signal(s32 amount)
+{
+    Assert(amount > 0);
+    count.FetchAdd(amount);
+    if (amount == 1) WakeByAddressSingle((void*)&count.value);
+    else WakeByAddressAll((void*)&count.value);
+}
+
+bool Platform::Barrier::Wait()
+{
+    Assert(thread_count > 0);
+    u32 current_generation = generation.Load();
+    if (arrived.FetchAdd(1) + 1 == thread_count)
+    {
+        // Last one in. Reset for the next use before releasing everyone.
+        arrived.Store(0);
+        generation.FetchAdd(1);
+        WakeByAddressAll((void*)&generation.value);
+        return true;
+    }
+
+    while (generation.Load() == current_generation)
+    {
+        WaitOnAddress(&generation.value, &current_generation, sizeof(current_generation), INFINITE);
+    }
+    return false;
+}
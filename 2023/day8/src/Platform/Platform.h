@@ -27,7 +27,128 @@ namespace Platform
     void PrintError(const char* message);
 	bool ShowAssertDialog(const char* message);
 
+	// CPU features that matter for picking SIMD kernels. Queried with cpuid the first time, then cached.
+	// The AVX flags also require the OS to save the wider registers, so they can be trusted as-is.
+	struct CpuFeatureFlags
+	{
+		bool sse42; // SSE4.2 (and everything before it, down to SSSE3).
+		bool popcnt;
+		bool avx2;
+		bool bmi2;
+		bool avx512; // AVX-512 F and BW.
+	};
+	const CpuFeatureFlags& CpuFeatures();
+
 	s64 GetFileSize(IString path);
 	Span<u8> ReadFileToBuffer(IString path);
     bool ReadFileToBuffer(IString path, Span<u8> buffer);
+
+    // Maps a whole file into memory, read-only. There's no copy, and any number of threads can read the
+    // mapping at once. Returns an empty span if the file can't be mapped (or is empty).
+    Span<const u8> MapFile(IString path);
+    void UnmapFile(Span<const u8> file);
+
+    // Threads. The function runs on the new thread, and the thread exits when it returns.
+    typedef void ThreadFunction(void* data);
+    struct Thread
+    {
+        void* handle;
+        u32 id;
+    };
+    Thread StartThread(ThreadFunction* function, void* data);
+    void JoinThread(Thread* thread); // Waits for the thread to finish, then releases it.
+    // Pins a thread to one logical core. Only the first 64 cores (processor group 0) can be picked, even on
+    // a machine with more, where GetCoreCount() counts all of them.
+    bool SetThreadAffinity(Thread* thread, s32 core);
+    bool SetCurrentThreadAffinity(s32 core);
+    s32 GetCoreCount(); // Logical cores, across all processor groups.
+    void YieldThread();
+
+    // Thread local storage slots, for per-thread data that a thread_local variable can't express
+    // (like one slot per instance of something).
+    u32 CreateThreadLocal();
+    void FreeThreadLocal(u32 slot);
+    void SetThreadLocal(u32 slot, void* value);
+    void* GetThreadLocal(u32 slot);
+
+    template <s64 Size> struct AtomicBits;
+    template <> struct AtomicBits<4> {using Type = LONG;};
+    template <> struct AtomicBits<8> {using Type = LONG64;};
+
+    /**
+     * Atomic 32 or 64 bit value (integers, enums, or pointers). Zero initialize it like anything else.
+     * Load() has acquire semantics and Store() has release semantics, and the read-modify-write
+     * operations are full barriers. FetchAdd() only makes sense for integers.
+     */
+    template <typename T> struct Atomic
+    {
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Atomic only supports 32 and 64 bit types.");
+        using Bits = typename AtomicBits<sizeof(T)>::Type;
+
+        volatile T value;
+
+        T Load() const {T result = value; _ReadWriteBarrier(); return result;}
+        void Store(T new_value) {_ReadWriteBarrier(); value = new_value;}
+
+        T Exchange(T new_value)
+        {
+            if constexpr (sizeof(T) == 4) return FromBits(InterlockedExchange(BitsPtr(), ToBits(new_value)));
+            else return FromBits(InterlockedExchange64(BitsPtr(), ToBits(new_value)));
+        }
+
+        // If the value is *expected, replaces it with desired and returns true.
+        // Otherwise, writes the current value to *expected and returns false.
+        bool CompareExchange(T* expected, T desired)
+        {
+            Bits previous;
+            if constexpr (sizeof(T) == 4) previous = InterlockedCompareExchange(BitsPtr(), ToBits(desired), ToBits(*expected));
+            else previous = InterlockedCompareExchange64(BitsPtr(), ToBits(desired), ToBits(*expected));
+            bool result = (previous == ToBits(*expected));
+            *expected = FromBits(previous);
+            return result;
+        }
+
+        T FetchAdd(T amount) // Returns the value from before the add.
+        {
+            if constexpr (sizeof(T) == 4) return FromBits(InterlockedExchangeAdd(BitsPtr(), ToBits(amount)));
+            else return FromBits(InterlockedExchangeAdd64(BitsPtr(), ToBits(amount)));
+        }
+
+    private:
+        volatile Bits* BitsPtr() {return (volatile Bits*)&value;}
+        static Bits ToBits(T in) {Bits result; memcpy(&result, &in, sizeof(result)); return result;}
+        static T FromBits(Bits in) {T result; memcpy(&result, &in, sizeof(result)); return result;}
+    };
+
+    // Futex style lock. Uncontended Lock() and Unlock() are a single atomic each, and only contended
+    // ones go to the OS (which parks waiting threads on the state word itself).
+    struct Mutex
+    {
+        Atomic<u32> state; // 0 = unlocked, 1 = locked, 2 = locked and there may be waiters.
+
+        void Lock();
+        bool TryLock();
+        void Unlock();
+    };
+
+    // Counting semaphore. Wait() takes one from the count, blocking while it's zero.
+    struct Semaphore
+    {
+        Atomic<s32> count;
+
+        void Wait();
+        bool TryWait();
+        void Signal(s32 amount = 1);
+    };
+
+    // Blocks threads in Wait() until thread_count of them have arrived, then releases them all. Reusable.
+    // Initialize with the thread count, like Barrier barrier = {8};
+    struct Barrier
+    {
+        u32 thread_count;
+        Atomic<u32> arrived;
+        Atomic<u32> generation;
+
+        bool Wait(); // Returns true on exactly one of the threads, in case one of them needs to do some serial work.
+    };
 };
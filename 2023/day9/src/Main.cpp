@@ -4,21 +4,6 @@
 
 #define DEFAULT_INPUT_PATH "input.txt"
 
-static s32 ParseNumber(const char* input, s32* offset)
-{
-    s32 result = 0;
-    bool is_negative = (input[*offset] == '-');
-    if (is_negative) *offset += 1;
-    while (input[*offset] >= '0' && input[*offset] <= '9')
-    {
-        s32 digit = input[*offset] - '0';
-        result = result * 10 + digit;
-        *offset += 1;
-    }
-    if (is_negative) result *= -1;
-    return result;
-}
-
 struct Sequence
 {
     TArray<s32> sequence;
@@ -46,7 +31,7 @@ bool GenerateSubSequence(Sequence* s, s32 parent_start)
     return is_all_zeros;
 }
 
-s32 PredictNext(Sequence* s)
+s32 PredictNext(const Sequence* s)
 {
     s32 length = s->smallest_length;
     s32 idx = s->sequence.Length() - length - 1;
@@ -61,7 +46,7 @@ s32 PredictNext(Sequence* s)
     return current;
 }
 
-s32 PredictPrevious(Sequence* s)
+s32 PredictPrevious(const Sequence* s)
 {
     s32 length = s->smallest_length;
     s32 idx = s->sequence.Length() - 1 - length - length;
@@ -77,27 +62,35 @@ s32 PredictPrevious(Sequence* s)
     return current;
 }
 
-static s64 DoPartOne(Span<char> input)
+// Each sequence from the input, already extended with all of its difference sequences down to the
+// one that is all zeros. Both parts predict from that, one forwards and one backwards.
+struct ParsedInput
 {
-    s32 offset = 0;
-    TArray<Sequence> sequences = {};
-    while (offset < (s32)input.count)
+    TArray<Sequence> sequences;
+};
+
+static ParsedInput Parse(Span<const char> input)
+{
+    ParsedInput result = {};
+    IString text = {input.ptr, (u32)input.count};
+    s64 offset = 0;
+    while (offset < (s64)input.count)
     {
         Sequence s = {};
         bool end_of_line = false;
-        while (!end_of_line && offset < (s32)input.count)
+        while (!end_of_line && offset < (s64)input.count)
         {
-            s32 num = ParseNumber(input.ptr, &offset);
+            s32 num = (s32)ParseSigned(text, &offset);
             s.sequence.Append(num);
             end_of_line = (input[offset] == '\n');
             offset += 1; // Skip past the space (or newline, if we just encountered it).
         }
         s.count = 1;
         s.smallest_length = s.sequence.Length();
-        sequences.Append(s);
+        result.sequences.Append(s);
     }
 
-    for (Sequence& s : sequences)
+    for (Sequence& s : result.sequences)
     {
         s32 last_start = 0;
         s32 next_start = s.sequence.Length();
@@ -107,97 +100,91 @@ static s64 DoPartOne(Span<char> input)
             next_start = s.sequence.Length();
         }
     }
+    return result;
+}
 
+static s64 DoPartOne(const ParsedInput& input)
+{
     s64 result = 0;
-
-    for (Sequence& s : sequences) result += (s64)PredictNext(&s);
-
-    // Sequence* test_sequence = &sequences[2];
-    // s32 last_start = 0;
-    // s32 next_start = test_sequence->sequence.Length();
-    // while (!GenerateSubSequence(test_sequence, last_start))
-    // {
-    //     last_start = next_start;
-    //     next_start = test_sequence->sequence.Length();
-    // }
-
-    // s32 next = PredictNext(test_sequence);
-    // s32 prev = PredictPrevious(test_sequence);
-    // for (s32 num : test_sequence->sequence) PrintF("%d ", num);
-    // PrintF("\n");
-    // PrintF("Next: %d, Prev: %d\n", next, prev);
-
-    // for (Sequence& s : sequences)
-    // {
-    //     for (s32 num : s.sequence) PrintF("%d ", num);
-    //     PrintF("\n");
-    // }
+    for (const Sequence& s : input.sequences) result += (s64)PredictNext(&s);
     return result;
 }
 
-static s64 DoPartTwo(Span<char> input)
+static s64 DoPartTwo(const ParsedInput& input)
 {
-    s32 offset = 0;
-    TArray<Sequence> sequences = {};
-    while (offset < (s32)input.count)
-    {
-        Sequence s = {};
-        bool end_of_line = false;
-        while (!end_of_line && offset < (s32)input.count)
-        {
-            s32 num = ParseNumber(input.ptr, &offset);
-            s.sequence.Append(num);
-            end_of_line = (input[offset] == '\n');
-            offset += 1; // Skip past the space (or newline, if we just encountered it).
-        }
-        s.count = 1;
-        s.smallest_length = s.sequence.Length();
-        sequences.Append(s);
-    }
+    s64 result = 0;
+    for (const Sequence& s : input.sequences) result += (s64)PredictPrevious(&s);
+    return result;
+}
 
-    for (Sequence& s : sequences)
-    {
-        s32 last_start = 0;
-        s32 next_start = s.sequence.Length();
-        while (!GenerateSubSequence(&s, last_start))
-        {
-            last_start = next_start;
-            next_start = s.sequence.Length();
-        }
-    }
+typedef s64 PartFunction(const ParsedInput& input);
 
-    s64 result = 0;
+struct PartRun
+{
+    PartFunction* function;
+    const ParsedInput* input;
+    s64 result;
+    u64 us;
+};
 
-    for (Sequence& s : sequences) result += (s64)PredictPrevious(&s);
-    return result;
+// Runs and times one part. Takes a void* so that it can also be a thread's entry point.
+static void RunPart(void* data)
+{
+    PartRun* run = (PartRun*)data;
+    Platform::Timer timer = {};
+    Platform::TimerStart(&timer);
+    run->result = run->function(*run->input);
+    run->us = Platform::TimerCountsToMicroseconds(&timer, Platform::TimerMeasureCounts(&timer));
 }
 
 int main(int argc, char* argv[])
 {
+    // Arguments are the input path (optional), and --concurrent to run the two parts at the same time.
+    IString path = DEFAULT_INPUT_PATH;
+    bool concurrent = false;
+    for (s32 i = 1; i < argc; ++i)
+    {
+        IString arg = argv[i];
+        if (arg == "--concurrent") concurrent = true;
+        else path = arg;
+    }
+
     // Read the input file into a buffer.
-    IString path = (argc > 1) ? argv[1] : DEFAULT_INPUT_PATH;
     Span<u8> input_file = Platform::ReadFileToBuffer(path);
 
     // Start timing.
     Platform::Timer timer = {};
     Platform::TimerStart(&timer);
 
-    // Do the actual work.
-    s64 part1 = DoPartOne({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part1_counts = Platform::TimerMeasureCounts(&timer);
+    // Parse once, for both parts.
+    ParsedInput parsed = Parse({(const char*)input_file.ptr, input_file.count});
+    u64 parse_counts = Platform::TimerMeasureCounts(&timer);
 
-    s64 part2 = DoPartTwo({(char*)input_file.ptr, (u32)input_file.count});
-    u64 part2_counts = Platform::TimerMeasureCounts(&timer);
+    // Do the actual work. Concurrently, part two gets a thread of its own while part one runs on this one.
+    PartRun part1 = {DoPartOne, &parsed};
+    PartRun part2 = {DoPartTwo, &parsed};
+    if (concurrent)
+    {
+        Platform::Thread thread = Platform::StartThread(RunPart, &part2);
+        AssertCustom(thread.handle, "Failed to start a thread for part two.");
+        RunPart(&part1);
+        Platform::JoinThread(&thread);
+    }
+    else
+    {
+        RunPart(&part1);
+        RunPart(&part2);
+    }
+    u64 total_counts = Platform::TimerMeasureCounts(&timer);
 
     // Stop timing.
-    u64 part1_us = Platform::TimerCountsToMicroseconds(&timer, part1_counts);
-    u64 part2_us = Platform::TimerCountsToMicroseconds(&timer, part2_counts - part1_counts);
+    u64 parse_us = Platform::TimerCountsToMicroseconds(&timer, parse_counts);
+    u64 total_us = Platform::TimerCountsToMicroseconds(&timer, total_counts);
 
     // Print results.
-    PrintF("Part 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\n", part1, part1_us, part2, part2_us);
+    PrintF("Parsed in %lldus\nPart 1: %lld (Computed in %lldus)\nPart 2: %lld (Computed in %lldus)\nTotal: %lldus%s\n",
+           parse_us, part1.result, part1.us, part2.result, part2.us, total_us, concurrent ? " (parts ran concurrently)" : "");
     // Free the input file and exit.
     free(input_file.ptr);
     return 0;
 }
-
-